@@ -7,9 +7,11 @@
 #ifndef CHAISCRIPT_STDLIB_HPP_
 #define CHAISCRIPT_STDLIB_HPP_
 
+#include <cstdint>
 #include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -21,9 +23,12 @@
 //#include "dispatchkit/dispatchkit.hpp"
 #include "dispatchkit/bootstrap.hpp"
 #include "dispatchkit/bootstrap_stl.hpp"
+#include "dispatchkit/integral_range.hpp"
 #include "dispatchkit/operators.hpp"
 //#include "dispatchkit/boxed_value.hpp"
 #include "dispatchkit/register_function.hpp"
+#include "dispatchkit/string_builder.hpp"
+#include "language/chaiscript_algorithms.hpp"
 #include "language/chaiscript_prelude.hpp"
 #include "utility/json_wrap.hpp"
 
@@ -44,8 +49,14 @@ namespace chaiscript {
 
       bootstrap::standard_library::vector_type<std::vector<Boxed_Value>>("Vector", *lib);
       bootstrap::standard_library::string_type<std::string>("string", *lib);
+      bootstrap::standard_library::string_builder_type<dispatch::String_Builder>("String_Builder", *lib);
       bootstrap::standard_library::map_type<std::map<std::string, Boxed_Value>>("Map", *lib);
+      bootstrap::standard_library::hash_map_type<std::unordered_map<std::string, Boxed_Value>>("Hash_Map", *lib);
       bootstrap::standard_library::pair_type<std::pair<Boxed_Value, Boxed_Value>>("Pair", *lib);
+      bootstrap::standard_library::integral_range_type<dispatch::Integral_Range>("Integral_Range", *lib);
+      bootstrap::standard_library::numeric_array_type<std::vector<std::int64_t>>("Int64_Array", *lib);
+      bootstrap::standard_library::numeric_array_type<std::vector<double>>("Double_Array", *lib);
+      bootstrap::standard_library::numeric_array_type<std::vector<float>>("Float_Array", *lib);
 
 #ifndef CHAISCRIPT_NO_THREADS
       bootstrap::standard_library::future_type<std::future<chaiscript::Boxed_Value>>("future", *lib);
@@ -56,7 +67,10 @@ namespace chaiscript {
 
       json_wrap::library(*lib);
 
-      lib->eval(ChaiScript_Prelude::chaiscript_prelude() /*, "standard prelude"*/);
+      lib->eval_library(ChaiScript_Prelude::chaiscript_prelude(), ChaiScript_Prelude::filename);
+
+      // after the prelude, which defines the versions these take over for Vectors and ranges
+      lib->add([](chaiscript::detail::Dispatch_Engine &t_engine) { Native_Algorithms::add(t_engine); });
 
       return lib;
     }
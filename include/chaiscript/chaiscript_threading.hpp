@@ -10,12 +10,15 @@
 #ifndef CHAISCRIPT_THREADING_HPP_
 #define CHAISCRIPT_THREADING_HPP_
 
-#include <unordered_map>
-
 #ifndef CHAISCRIPT_NO_THREADS
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
 #include <mutex>
 #include <shared_mutex>
 #include <thread>
+#include <vector>
 #else
 #ifndef CHAISCRIPT_NO_THREADS_WARNING
 #pragma message("ChaiScript is compiling without thread safety.")
@@ -53,36 +56,123 @@ namespace chaiscript::detail::threading {
 
   using std::recursive_mutex;
 
-  /// Typesafe thread specific storage. If threading is enabled, this class uses a mutex protected map. If
-  /// threading is not enabled, the class always returns the same data, regardless of which thread it is called from.
+  /// Typesafe thread specific storage. If threading is enabled, each Thread_Storage object is assigned
+  /// a slot index at construction and every thread keeps a vector of values indexed by that slot, so
+  /// an access is a bounds check and a generation compare, never a hash lookup. Slot indexes are
+  /// recycled when a Thread_Storage is destroyed; the generation number detects a stale value left
+  /// behind by a previous owner of the slot on some other thread.
+  /// If threading is not enabled, the class always returns the same data, regardless of which thread it is called from.
   template<typename T>
   class Thread_Storage {
   public:
-    Thread_Storage() = default;
+    Thread_Storage()
+        : m_generation(++generation_counter())
+        , m_index(slots().acquire()) {
+    }
+
     Thread_Storage(const Thread_Storage &) = delete;
     Thread_Storage(Thread_Storage &&) = delete;
     Thread_Storage &operator=(const Thread_Storage &) = delete;
     Thread_Storage &operator=(Thread_Storage &&) = delete;
 
-    ~Thread_Storage() { t().erase(this); }
-
-    inline const T *operator->() const noexcept { return &(t()[this]); }
+    ~Thread_Storage() {
+      auto &values = t();
+      std::unique_ptr<T> obj;
+      if (m_index < values.size() && values[m_index].generation == m_generation) {
+        values[m_index].generation = 0;
+        obj = std::move(values[m_index].obj);
+      }
+      slots().release(m_index);
+      // obj may own further Thread_Storage objects, which touch the same vector when they are destroyed
+    }
 
-    inline const T &operator*() const noexcept { return t()[this]; }
+    inline const T *operator->() const noexcept { return &get(); }
 
-    inline T *operator->() noexcept { return &(t()[this]); }
+    inline const T &operator*() const noexcept { return get(); }
 
-    inline T &operator*() noexcept { return t()[this]; }
+    inline T *operator->() noexcept { return &get(); }
 
-    void *m_key;
+    inline T &operator*() noexcept { return get(); }
 
   private:
+    struct Value {
+      std::uint64_t generation = 0;
+      std::unique_ptr<T> obj;
+    };
+
+    /// Hands out slot indexes, reusing the ones released by destroyed Thread_Storage objects
+    struct Slots {
+      std::size_t acquire() {
+        std::lock_guard<std::mutex> l(m_mutex);
+        if (m_free.empty()) {
+          return m_next++;
+        }
+        const auto index = m_free.back();
+        m_free.pop_back();
+        return index;
+      }
+
+      void release(const std::size_t t_index) {
+        std::lock_guard<std::mutex> l(m_mutex);
+        m_free.push_back(t_index);
+      }
+
+      std::mutex m_mutex;
+      std::vector<std::size_t> m_free;
+      std::size_t m_next = 0;
+    };
+
     /// todo: is it valid to make this noexcept? The allocation could fail, but if it
     /// does there is no possible way to recover
-    static std::unordered_map<const void *, T> &t() noexcept {
-      static thread_local std::unordered_map<const void *, T> my_t;
+    T &get() const noexcept {
+      auto &values = t();
+      if (m_index < values.size()) {
+        auto &value = values[m_index];
+        if (value.generation == m_generation) {
+          return *value.obj;
+        }
+      } else {
+        values.resize(m_index + 1);
+      }
+
+      auto &value = values[m_index];
+      value.generation = m_generation;
+      value.obj = std::make_unique<T>();
+      return *value.obj;
+    }
+
+    /// Per thread values. At thread exit the values are released one at a time, because a value may
+    /// own other Thread_Storage objects whose destructors look themselves up in this same vector
+    struct Values : std::vector<Value> {
+      Values() = default;
+      Values(const Values &) = delete;
+      Values &operator=(const Values &) = delete;
+
+      ~Values() {
+        while (!this->empty()) {
+          auto obj = std::move(this->back().obj);
+          this->pop_back();
+        }
+      }
+    };
+
+    static std::vector<Value> &t() noexcept {
+      static thread_local Values my_t;
       return my_t;
     }
+
+    static Slots &slots() noexcept {
+      static Slots my_slots;
+      return my_slots;
+    }
+
+    static std::atomic<std::uint64_t> &generation_counter() noexcept {
+      static std::atomic<std::uint64_t> counter{0};
+      return counter;
+    }
+
+    std::uint64_t m_generation;
+    std::size_t m_index;
   };
 
 #else // threading disabled
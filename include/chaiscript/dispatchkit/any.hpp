@@ -7,6 +7,8 @@
 #ifndef CHAISCRIPT_ANY_HPP_
 #define CHAISCRIPT_ANY_HPP_
 
+#include <memory>
+#include <type_traits>
 #include <utility>
 
 namespace chaiscript {
@@ -26,6 +28,14 @@ namespace chaiscript {
 
     class Any {
     private:
+      template<typename T>
+      struct Is_Shared_Ptr : std::false_type {
+      };
+
+      template<typename T>
+      struct Is_Shared_Ptr<std::shared_ptr<T>> : std::true_type {
+      };
+
       struct Data {
         constexpr explicit Data(const std::type_info &t_type) noexcept
             : m_type(t_type) {
@@ -40,6 +50,9 @@ namespace chaiscript {
         const std::type_info &type() const noexcept { return m_type; }
 
         virtual std::unique_ptr<Data> clone() const = 0;
+
+        virtual bool is_sole_owner() const noexcept = 0;
+
         const std::type_info &m_type;
       };
 
@@ -54,6 +67,14 @@ namespace chaiscript {
 
         std::unique_ptr<Data> clone() const override { return std::make_unique<Data_Impl<T>>(m_data); }
 
+        bool is_sole_owner() const noexcept override {
+          if constexpr (Is_Shared_Ptr<T>::value) {
+            return m_data.use_count() == 1;
+          } else {
+            return false;
+          }
+        }
+
         Data_Impl &operator=(const Data_Impl &) = delete;
 
         T m_data;
@@ -100,6 +121,9 @@ namespace chaiscript {
       // queries
       bool empty() const noexcept { return !static_cast<bool>(m_data); }
 
+      /// \returns true if the held value is a std::shared_ptr and no other shared_ptr owns its object
+      bool is_sole_owner() const noexcept { return m_data && m_data->is_sole_owner(); }
+
       const std::type_info &type() const noexcept {
         if (m_data) {
           return m_data->type();
@@ -42,7 +42,7 @@ namespace chaiscript::bootstrap {
           }),
           "[]");
 
-    m.add(fun([](const T &) { return std::extent<T>::value; }), "size");
+    m.add(fun([](const T &) { return std::extent<T>::value; }, chaiscript::pure), "size");
   }
 
   /// \brief Adds a copy constructor for the given type to the given Model
@@ -88,7 +88,7 @@ namespace chaiscript::bootstrap {
   /// \param[in,out] m The Module to add the constructor to
   template<typename T>
   void construct_pod(const std::string &type, Module &m) {
-    m.add(fun([](const Boxed_Number &bn) { return bn.get_as<T>(); }), type);
+    m.add(fun([](const Boxed_Number &bn) { return bn.get_as<T>(); }, chaiscript::pure), type);
   }
 
   /// Internal function for converting from a string to a value
@@ -113,8 +113,8 @@ namespace chaiscript::bootstrap {
     m.add(constructor<T()>(), name);
     construct_pod<T>(name, m);
 
-    m.add(fun(&parse_string<T>), "to_" + name);
-    m.add(fun([](const T t) { return t; }), "to_" + name);
+    m.add(fun(&parse_string<T>, chaiscript::pure), "to_" + name);
+    m.add(fun([](const T t) { return t; }, chaiscript::pure), "to_" + name);
   }
 
   /// "clone" function for a shared_ptr type. This is used in the case
@@ -165,19 +165,19 @@ namespace chaiscript::bootstrap {
 
     /// Add all arithmetic operators for PODs
     static void opers_arithmetic_pod(Module &m) {
-      m.add(fun(&Boxed_Number::equals), "==");
-      m.add(fun(&Boxed_Number::less_than), "<");
-      m.add(fun(&Boxed_Number::greater_than), ">");
-      m.add(fun(&Boxed_Number::greater_than_equal), ">=");
-      m.add(fun(&Boxed_Number::less_than_equal), "<=");
-      m.add(fun(&Boxed_Number::not_equal), "!=");
+      m.add(fun(&Boxed_Number::equals, chaiscript::pure), "==");
+      m.add(fun(&Boxed_Number::less_than, chaiscript::pure), "<");
+      m.add(fun(&Boxed_Number::greater_than, chaiscript::pure), ">");
+      m.add(fun(&Boxed_Number::greater_than_equal, chaiscript::pure), ">=");
+      m.add(fun(&Boxed_Number::less_than_equal, chaiscript::pure), "<=");
+      m.add(fun(&Boxed_Number::not_equal, chaiscript::pure), "!=");
 
       m.add(fun(&Boxed_Number::pre_decrement), "--");
       m.add(fun(&Boxed_Number::pre_increment), "++");
-      m.add(fun(&Boxed_Number::sum), "+");
-      m.add(fun(&Boxed_Number::unary_plus), "+");
-      m.add(fun(&Boxed_Number::unary_minus), "-");
-      m.add(fun(&Boxed_Number::difference), "-");
+      m.add(fun(&Boxed_Number::sum, chaiscript::pure), "+");
+      m.add(fun(&Boxed_Number::unary_plus, chaiscript::pure), "+");
+      m.add(fun(&Boxed_Number::unary_minus, chaiscript::pure), "-");
+      m.add(fun(&Boxed_Number::difference, chaiscript::pure), "-");
       m.add(fun(&Boxed_Number::assign_bitwise_and), "&=");
       m.add(fun(&Boxed_Number::assign), "=");
       m.add(fun(&Boxed_Number::assign_bitwise_or), "|=");
@@ -185,19 +185,19 @@ namespace chaiscript::bootstrap {
       m.add(fun(&Boxed_Number::assign_remainder), "%=");
       m.add(fun(&Boxed_Number::assign_shift_left), "<<=");
       m.add(fun(&Boxed_Number::assign_shift_right), ">>=");
-      m.add(fun(&Boxed_Number::bitwise_and), "&");
-      m.add(fun(&Boxed_Number::bitwise_complement), "~");
-      m.add(fun(&Boxed_Number::bitwise_xor), "^");
-      m.add(fun(&Boxed_Number::bitwise_or), "|");
+      m.add(fun(&Boxed_Number::bitwise_and, chaiscript::pure), "&");
+      m.add(fun(&Boxed_Number::bitwise_complement, chaiscript::pure), "~");
+      m.add(fun(&Boxed_Number::bitwise_xor, chaiscript::pure), "^");
+      m.add(fun(&Boxed_Number::bitwise_or, chaiscript::pure), "|");
       m.add(fun(&Boxed_Number::assign_product), "*=");
       m.add(fun(&Boxed_Number::assign_quotient), "/=");
       m.add(fun(&Boxed_Number::assign_sum), "+=");
       m.add(fun(&Boxed_Number::assign_difference), "-=");
-      m.add(fun(&Boxed_Number::quotient), "/");
-      m.add(fun(&Boxed_Number::shift_left), "<<");
-      m.add(fun(&Boxed_Number::product), "*");
-      m.add(fun(&Boxed_Number::remainder), "%");
-      m.add(fun(&Boxed_Number::shift_right), ">>");
+      m.add(fun(&Boxed_Number::quotient, chaiscript::pure), "/");
+      m.add(fun(&Boxed_Number::shift_left, chaiscript::pure), "<<");
+      m.add(fun(&Boxed_Number::product, chaiscript::pure), "*");
+      m.add(fun(&Boxed_Number::remainder, chaiscript::pure), "%");
+      m.add(fun(&Boxed_Number::shift_right, chaiscript::pure), ">>");
     }
 
     /// Create a bound function object. The first param is the function to bind
@@ -391,13 +391,13 @@ namespace chaiscript::bootstrap {
       operators::equal<bool>(m);
       operators::not_equal<bool>(m);
 
-      m.add(fun([](const std::string &s) { return s; }), "to_string");
-      m.add(fun([](const bool b) { return std::string(b ? "true" : "false"); }), "to_string");
+      m.add(fun([](const std::string &s) { return s; }, chaiscript::pure), "to_string");
+      m.add(fun([](const bool b) { return std::string(b ? "true" : "false"); }, chaiscript::pure), "to_string");
       m.add(fun(&unknown_assign), "=");
       m.add(fun([](const Boxed_Value &bv) { throw bv; }), "throw");
 
-      m.add(fun([](const char c) { return std::string(1, c); }), "to_string");
-      m.add(fun(&Boxed_Number::to_string), "to_string");
+      m.add(fun([](const char c) { return std::string(1, c); }, chaiscript::pure), "to_string");
+      m.add(fun(&Boxed_Number::to_string, chaiscript::pure), "to_string");
 
       bootstrap_pod_type<double>("double", m);
       bootstrap_pod_type<long double>("long_double", m);
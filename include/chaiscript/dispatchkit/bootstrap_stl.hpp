@@ -15,15 +15,23 @@
 #ifndef CHAISCRIPT_BOOTSTRAP_STL_HPP_
 #define CHAISCRIPT_BOOTSTRAP_STL_HPP_
 
+#include <array>
+#include <atomic>
 #include <functional>
+#include <iterator>
+#include <map>
 #include <memory>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <typeinfo>
+#include <unordered_map>
 #include <vector>
 
 #include "bootstrap.hpp"
 #include "boxed_value.hpp"
 #include "dispatchkit.hpp"
+#include "numeric_array.hpp"
 #include "operators.hpp"
 #include "proxy_constructors.hpp"
 #include "register_function.hpp"
@@ -79,6 +87,20 @@ namespace chaiscript::bootstrap::standard_library {
   };
 
   namespace detail {
+    /// Appends the text of t_bv, as `to_string` gives it, to t_text
+    inline void append_text(const chaiscript::detail::Dispatch_Engine &t_engine,
+                            const Type_Conversions_State &t_conversions,
+                            std::atomic_uint_fast32_t &t_to_string_loc,
+                            std::string &t_text,
+                            const Boxed_Value &t_bv) {
+      if (t_bv.get_type_info().bare_equal_type_info(typeid(std::string))) {
+        t_text += *static_cast<const std::string *>(t_bv.get_const_ptr());
+      } else {
+        std::array<Boxed_Value, 1> params{t_bv};
+        t_text += boxed_cast<const std::string &>(t_engine.call_function("to_string", t_to_string_loc, Function_Params{params}, t_conversions));
+      }
+    }
+
     template<typename T>
     size_t count(const T &t_target, const typename T::key_type &t_key) {
       return t_target.count(t_key);
@@ -94,7 +116,8 @@ namespace chaiscript::bootstrap::standard_library {
       t_target.insert(t_val);
     }
 
-    /// Add Bidir_Range support for the given ContainerType
+    /// Add Bidir_Range support for the given ContainerType. Over iterators that only go forward, such as those
+    /// of a hashed container, the range has no `pop_back` or `back`.
     template<typename Bidir_Type>
     void input_range_type_impl(const std::string &type, Module &m) {
       m.add(user_type<Bidir_Type>(), type + "_Range");
@@ -106,8 +129,12 @@ namespace chaiscript::bootstrap::standard_library {
       m.add(fun(&Bidir_Type::empty), "empty");
       m.add(fun(&Bidir_Type::pop_front), "pop_front");
       m.add(fun(&Bidir_Type::front), "front");
-      m.add(fun(&Bidir_Type::pop_back), "pop_back");
-      m.add(fun(&Bidir_Type::back), "back");
+
+      using iterator_category = typename std::iterator_traits<decltype(Bidir_Type::m_begin)>::iterator_category;
+      if constexpr (std::is_base_of_v<std::bidirectional_iterator_tag, iterator_category>) {
+        m.add(fun(&Bidir_Type::pop_back), "pop_back");
+        m.add(fun(&Bidir_Type::back), "back");
+      }
     }
 
     /// Algorithm for inserting at a specific position into a container
@@ -137,12 +164,73 @@ namespace chaiscript::bootstrap::standard_library {
       std::advance(itr, pos);
       container.erase(itr);
     }
+
+    /// Add t_oper and t_oper= for a numeric ArrayType, elementwise between two arrays of the same size and
+    /// between an array and a number. With Divides, integer divisors are checked for zero first.
+    template<typename ArrayType, bool Divides, typename Oper>
+    void numeric_array_operator(const std::string &t_oper, Oper t_func, Module &m) {
+      using T = typename ArrayType::value_type;
+      namespace numeric_array = dispatch::numeric_array;
+
+      const auto check = [](const T *t_begin, const T *t_end) {
+        if constexpr (Divides) {
+          numeric_array::check_divisors(t_begin, t_end);
+        }
+      };
+
+      m.add(fun([t_func, check](const ArrayType &t_lhs, const ArrayType &t_rhs) {
+              check(t_rhs.data(), t_rhs.data() + t_rhs.size());
+              return numeric_array::elementwise(t_lhs, t_rhs, t_func);
+            }),
+            t_oper);
+      m.add(fun([t_func, check](const ArrayType &t_lhs, const T t_rhs) {
+              check(&t_rhs, &t_rhs + 1);
+              return numeric_array::elementwise(t_lhs, t_rhs, t_func);
+            }),
+            t_oper);
+      m.add(fun([t_func, check](const T t_lhs, const ArrayType &t_rhs) {
+              check(t_rhs.data(), t_rhs.data() + t_rhs.size());
+              return numeric_array::elementwise(t_lhs, t_rhs, t_func);
+            }),
+            t_oper);
+      m.add(fun([t_func, check](ArrayType &t_lhs, const ArrayType &t_rhs) -> ArrayType & {
+              check(t_rhs.data(), t_rhs.data() + t_rhs.size());
+              return numeric_array::assign_elementwise(t_lhs, t_rhs, t_func);
+            }),
+            t_oper + "=");
+      m.add(fun([t_func, check](ArrayType &t_lhs, const T t_rhs) -> ArrayType & {
+              check(&t_rhs, &t_rhs + 1);
+              return numeric_array::assign_elementwise(t_lhs, t_rhs, t_func);
+            }),
+            t_oper + "=");
+    }
   } // namespace detail
 
   template<typename ContainerType>
   void input_range_type(const std::string &type, Module &m) {
     detail::input_range_type_impl<Bidir_Range<ContainerType, typename ContainerType::iterator>>(type, m);
     detail::input_range_type_impl<Bidir_Range<const ContainerType, typename ContainerType::const_iterator>>("Const_" + type, m);
+    m.add(native_iteration<ContainerType>());
+  }
+
+  /// Add the range a range literal evaluates to where it is consumed right away, see dispatch::Integral_Range.
+  /// Besides the range functions the prelude's algorithms use, it can be indexed, sized and turned into the Vector
+  /// `generate_range` would have made; `new` makes an empty Vector for the results
+  template<typename RangeType>
+  void integral_range_type(const std::string &type, Module &m) {
+    m.add(user_type<RangeType>(), type);
+
+    copy_constructor<RangeType>(type, m);
+
+    m.add(fun(&RangeType::empty), "empty");
+    m.add(fun(&RangeType::size), "size");
+    m.add(fun(&RangeType::pop_front), "pop_front");
+    m.add(fun(&RangeType::front), "front");
+    m.add(fun(&RangeType::pop_back), "pop_back");
+    m.add(fun(&RangeType::back), "back");
+    m.add(fun([](const RangeType &r, int index) { return r.at(static_cast<size_t>(index)); }), "[]");
+    m.add(fun(&RangeType::to_vector), "to_vector");
+    m.add(fun([](const RangeType &) { return std::vector<Boxed_Value>(); }), "new");
   }
 
   /// Add random_access_container concept to the given ContainerType
@@ -197,8 +285,8 @@ namespace chaiscript::bootstrap::standard_library {
   /// http://www.sgi.com/tech/stl/Container.html
   template<typename ContainerType>
   void container_type(const std::string & /*type*/, Module &m) {
-    m.add(fun([](const ContainerType *a) { return a->size(); }), "size");
-    m.add(fun([](const ContainerType *a) { return a->empty(); }), "empty");
+    m.add(fun([](const ContainerType *a) { return a->size(); }, chaiscript::pure), "size");
+    m.add(fun([](const ContainerType *a) { return a->empty(); }, chaiscript::pure), "empty");
     m.add(fun([](ContainerType *a) { a->clear(); }), "clear");
   }
 
@@ -404,6 +492,52 @@ namespace chaiscript::bootstrap::standard_library {
     input_range_type<MapType>(type, m);
   }
 
+  /// Add a hashed MapType container, such as std::unordered_map, with the script functions map_type gives a Map
+  /// and `reserve`. Its elements are walked in no particular order, and only forward. They are the same pairs
+  /// as the elements of the std::map with the same key and mapped types, whose map_type registration adds the
+  /// pair functions; `Type(Map)` makes one from such a std::map.
+  template<typename MapType>
+  void hash_map_type(const std::string &type, Module &m) {
+    using Ordered_Map = std::map<typename MapType::key_type, typename MapType::mapped_type>;
+
+    m.add(user_type<MapType>(), type);
+
+    using elem_access = typename MapType::mapped_type &(MapType::*)(const typename MapType::key_type &);
+    using const_elem_access = const typename MapType::mapped_type &(MapType::*)(const typename MapType::key_type &) const;
+
+    m.add(fun(static_cast<elem_access>(&MapType::operator[])), "[]");
+
+    m.add(fun(static_cast<elem_access>(&MapType::at)), "at");
+    m.add(fun(static_cast<const_elem_access>(&MapType::at)), "at");
+
+    m.add(fun([](const Ordered_Map &t_map) { return MapType(t_map.begin(), t_map.end()); }), type);
+    m.add(fun([](MapType *a, typename MapType::size_type n) { a->reserve(n); }), "reserve");
+
+    if (typeid(MapType) == typeid(std::unordered_map<std::string, Boxed_Value>)) {
+      m.eval(R"(
+                    def Hash_Map::`==`(Hash_Map rhs) {
+                       if ( rhs.size() != this.size() ) {
+                         return false;
+                       } else {
+                         for (p : this)
+                         {
+                           if (rhs.count(p.first) == 0 || !eq(p.second, rhs.at(p.first)))
+                           {
+                             return false;
+                           }
+                         }
+                         true;
+                       }
+                   } )");
+    }
+
+    container_type<MapType>(type, m);
+    default_constructible_type<MapType>(type, m);
+    assignable_type<MapType>(type, m);
+    unique_associative_container_type<MapType>(type, m);
+    input_range_type<MapType>(type, m);
+  }
+
   /// http://www.sgi.com/tech/stl/List.html
   template<typename ListType>
   void list_type(const std::string &type, Module &m) {
@@ -476,6 +610,37 @@ namespace chaiscript::bootstrap::standard_library {
     }
   }
 
+  /// Create a typed numeric array: a vector of one arithmetic type, held unboxed, see dispatch::numeric_array.
+  /// Besides the vector concepts it gets elementwise `+`, `-`, `*` and `/` with another array of the same size
+  /// or with a number, the reductions `sum`, `min`, `max` and `dot`, `slice`, and conversions to and from Vector
+  template<typename ArrayType>
+  void numeric_array_type(const std::string &type, Module &m) {
+    using T = typename ArrayType::value_type;
+    namespace numeric_array = dispatch::numeric_array;
+
+    vector_type<ArrayType>(type, m);
+
+    m.add(constructor<ArrayType(typename ArrayType::size_type)>(), type);
+    m.add(constructor<ArrayType(typename ArrayType::size_type, const T &)>(), type);
+    m.add(fun(&numeric_array::from_vector<T>), type);
+    m.add(fun(&numeric_array::to_vector<T>), "to_vector");
+
+    detail::numeric_array_operator<ArrayType, false>("+", std::plus<T>(), m);
+    detail::numeric_array_operator<ArrayType, false>("-", std::minus<T>(), m);
+    detail::numeric_array_operator<ArrayType, false>("*", std::multiplies<T>(), m);
+    detail::numeric_array_operator<ArrayType, true>("/", std::divides<T>(), m);
+
+    m.add(fun([](const ArrayType &t_lhs, const ArrayType &t_rhs) { return t_lhs == t_rhs; }), "==");
+    m.add(fun([](const ArrayType &t_lhs, const ArrayType &t_rhs) { return t_lhs != t_rhs; }), "!=");
+
+    m.add(fun([](const ArrayType &t_array) { return numeric_array::sum(t_array); }), "sum");
+    m.add(fun([](const ArrayType &t_array) { return numeric_array::min(t_array); }), "min");
+    m.add(fun([](const ArrayType &t_array) { return numeric_array::max(t_array); }), "max");
+    m.add(fun([](const ArrayType &t_lhs, const ArrayType &t_rhs) { return numeric_array::dot(t_lhs, t_rhs); }), "dot");
+    m.add(fun([](const ArrayType &t_array, const size_t t_begin, const size_t t_end) { return numeric_array::slice(t_array, t_begin, t_end); }),
+          "slice");
+  }
+
   /// Add a String container
   /// http://www.sgi.com/tech/stl/basic_string.html
   template<typename String>
@@ -500,22 +665,102 @@ namespace chaiscript::bootstrap::standard_library {
       }
     }());
 
-    m.add(fun([](const String *s, const String &f, size_t pos) { return s->find(f, pos); }), "find");
-    m.add(fun([](const String *s, const String &f, size_t pos) { return s->rfind(f, pos); }), "rfind");
-    m.add(fun([](const String *s, const String &f, size_t pos) { return s->find_first_of(f, pos); }), "find_first_of");
-    m.add(fun([](const String *s, const String &f, size_t pos) { return s->find_last_of(f, pos); }), "find_last_of");
-    m.add(fun([](const String *s, const String &f, size_t pos) { return s->find_last_not_of(f, pos); }), "find_last_not_of");
-    m.add(fun([](const String *s, const String &f, size_t pos) { return s->find_first_not_of(f, pos); }), "find_first_not_of");
+    m.add(fun([](const String *s, const String &f, size_t pos) { return s->find(f, pos); }, chaiscript::pure), "find");
+    m.add(fun([](const String *s, const String &f, size_t pos) { return s->rfind(f, pos); }, chaiscript::pure), "rfind");
+    m.add(fun([](const String *s, const String &f, size_t pos) { return s->find_first_of(f, pos); }, chaiscript::pure), "find_first_of");
+    m.add(fun([](const String *s, const String &f, size_t pos) { return s->find_last_of(f, pos); }, chaiscript::pure), "find_last_of");
+    m.add(fun([](const String *s, const String &f, size_t pos) { return s->find_last_not_of(f, pos); }, chaiscript::pure), "find_last_not_of");
+    m.add(fun([](const String *s, const String &f, size_t pos) { return s->find_first_not_of(f, pos); }, chaiscript::pure), "find_first_not_of");
 
     m.add(fun([](String *s, typename String::value_type c) -> decltype(auto) { return (*s += c); }), "+=");
 
     m.add(fun([](String *s) { s->clear(); }), "clear");
-    m.add(fun([](const String *s) { return s->empty(); }), "empty");
-    m.add(fun([](const String *s) { return s->size(); }), "size");
+    m.add(fun([](const String *s) { return s->empty(); }, chaiscript::pure), "empty");
+    m.add(fun([](const String *s) { return s->size(); }, chaiscript::pure), "size");
 
     m.add(fun([](const String *s) { return s->c_str(); }), "c_str");
     m.add(fun([](const String *s) { return s->data(); }), "data");
-    m.add(fun([](const String *s, size_t pos, size_t len) { return s->substr(pos, len); }), "substr");
+    m.add(fun([](const String *s, size_t pos, size_t len) { return s->substr(pos, len); }, chaiscript::pure), "substr");
+  }
+
+  /// Add a string builder, see dispatch::String_Builder. `+=` and `append` add a string, a character, a bool or a
+  /// number to it directly, and any other value as `to_string` gives it; `to_string` copies the text out and `take`
+  /// moves it out. Also adds `format(text, values...)`, which gives text with each `{}` in it replaced by the text
+  /// of the next value, and `{{` and `}}` by single braces
+  template<typename Builder>
+  void string_builder_type(const std::string &type, Module &m) {
+    m.add(user_type<Builder>(), type);
+    default_constructible_type<Builder>(type, m);
+    assignable_type<Builder>(type, m);
+    m.add(constructor<Builder(const std::string &)>(), type);
+
+    for (const auto *name : {"+=", "append"}) {
+      m.add(fun([](Builder &b, const std::string &s) -> Builder & { return b.append(s); }), name);
+      m.add(fun([](Builder &b, const char c) -> Builder & { return b.append(c); }), name);
+      m.add(fun([](Builder &b, const bool t_b) -> Builder & { return b.append(t_b ? "true" : "false"); }), name);
+      m.add(fun([](Builder &b, const Boxed_Number &n) -> Builder & { return b.append(n.to_string()); }), name);
+    }
+
+    m.add(fun([](const Builder *b) { return b->size(); }, chaiscript::pure), "size");
+    m.add(fun([](const Builder *b) { return b->empty(); }, chaiscript::pure), "empty");
+    m.add(fun([](Builder *b) { b->clear(); }), "clear");
+    m.add(fun([](Builder *b, size_t n) { b->reserve(n); }), "reserve");
+    m.add(fun([](const Builder *b) { return b->capacity(); }), "capacity");
+    m.add(fun([](const Builder *b) { return b->str(); }), "to_string");
+    m.add(fun([](Builder *b) { return b->take(); }), "take");
+
+    // these call `to_string`, so they are bound to the engine
+    m.add([](chaiscript::detail::Dispatch_Engine &t_engine) {
+      auto &engine = t_engine;
+
+      for (const auto *name : {"+=", "append"}) {
+        engine.add(fun([&engine](Builder &b, const Boxed_Value &t_bv) -> Builder & {
+                     const Type_Conversions_State conversions(engine.conversions(), engine.conversions().conversion_saves());
+                     std::atomic_uint_fast32_t to_string_loc = {0};
+                     std::string text;
+                     detail::append_text(engine, conversions, to_string_loc, text, t_bv);
+                     return b.append(text);
+                   }),
+                   name);
+      }
+
+      engine.add(dispatch::make_dynamic_proxy_function([&engine](const Function_Params &t_params) {
+                   if (t_params.empty()) {
+                     throw exception::arity_error(0, 1);
+                   }
+
+                   const auto &text = boxed_cast<const std::string &>(t_params[0]);
+                   const Type_Conversions_State conversions(engine.conversions(), engine.conversions().conversion_saves());
+                   std::atomic_uint_fast32_t to_string_loc = {0};
+                   std::string retval;
+                   retval.reserve(text.size());
+                   std::size_t next = 1;
+
+                   for (std::size_t i = 0; i < text.size(); ++i) {
+                     const char c = text[i];
+                     if ((c == '{' || c == '}') && i + 1 < text.size() && text[i + 1] == c) {
+                       retval += c;
+                       ++i;
+                     } else if (c == '{' && i + 1 < text.size() && text[i + 1] == '}') {
+                       if (next == t_params.size()) {
+                         throw exception::eval_error("More '{}' than values given to 'format'");
+                       }
+                       detail::append_text(engine, conversions, to_string_loc, retval, t_params[next++]);
+                       ++i;
+                     } else if (c == '{' || c == '}') {
+                       throw exception::eval_error("Unmatched '" + std::string(1, c) + "' in text given to 'format'");
+                     } else {
+                       retval += c;
+                     }
+                   }
+
+                   if (next != t_params.size()) {
+                     throw exception::eval_error("More values than '{}' given to 'format'");
+                   }
+                   return Boxed_Value(std::move(retval));
+                 }),
+                 "format");
+    });
   }
 
   /// Add a MapType container
@@ -679,6 +679,28 @@ namespace chaiscript {
 
     static Boxed_Value do_oper(Operators::Opers t_oper, const Boxed_Value &t_lhs) { return oper(t_oper, t_lhs); }
 
+    /// Applies a comparison operator to two unboxed numbers, with the same (C++) semantics
+    /// as do_oper would give for the boxed values. Non-comparison operators return false.
+    template<typename LHS, typename RHS>
+    static constexpr bool compare(Operators::Opers t_oper, const LHS &c_lhs, const RHS &c_rhs) noexcept {
+      switch (t_oper) {
+        case Operators::Opers::equals:
+          return c_lhs == c_rhs;
+        case Operators::Opers::less_than:
+          return c_lhs < c_rhs;
+        case Operators::Opers::greater_than:
+          return c_lhs > c_rhs;
+        case Operators::Opers::less_than_equal:
+          return c_lhs <= c_rhs;
+        case Operators::Opers::greater_than_equal:
+          return c_lhs >= c_rhs;
+        case Operators::Opers::not_equal:
+          return c_lhs != c_rhs;
+        default:
+          return false;
+      }
+    }
+
     Boxed_Value bv;
   };
 
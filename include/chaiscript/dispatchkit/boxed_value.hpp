@@ -199,6 +199,12 @@ namespace chaiscript {
 
     void reset_return_value() const noexcept { m_data->m_return_value = false; }
 
+    /// \returns true if no other Boxed_Value shares this value or the object it owns, so that it can be
+    ///          taken over instead of copied
+    bool is_unshared() const noexcept {
+      return m_data.use_count() == 1 && !m_data->m_is_ref && !is_const() && m_data->m_obj.is_sole_owner();
+    }
+
     bool is_pointer() const noexcept { return !is_ref(); }
 
     void *get_ptr() const noexcept { return m_data->m_data_ptr; }
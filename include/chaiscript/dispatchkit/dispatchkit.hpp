@@ -11,7 +11,9 @@
 #define CHAISCRIPT_DISPATCHKIT_HPP_
 
 #include <algorithm>
+#include <functional>
 #include <iostream>
+#include <iterator>
 #include <list>
 #include <map>
 #include <memory>
@@ -20,17 +22,20 @@
 #include <string>
 #include <string_view>
 #include <typeinfo>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
 #include "../chaiscript_defines.hpp"
 #include "../chaiscript_threading.hpp"
+#include "../utility/interned_string.hpp"
 #include "../utility/quick_flat_map.hpp"
 #include "bad_boxed_cast.hpp"
 #include "boxed_cast.hpp"
 #include "boxed_cast_helper.hpp"
 #include "boxed_value.hpp"
 #include "dynamic_object.hpp"
+#include "native_iteration.hpp"
 #include "proxy_constructors.hpp"
 #include "proxy_functions.hpp"
 #include "short_alloc.hpp"
@@ -45,6 +50,9 @@ namespace chaiscript {
   namespace parser {
     class ChaiScript_Parser_Base;
   }
+  namespace detail {
+    class Dispatch_Engine;
+  }
   namespace dispatch {
     class Dynamic_Proxy_Function;
     class Proxy_Function_Base;
@@ -137,11 +145,29 @@ namespace chaiscript {
       return *this;
     }
 
+    Module &add(Native_Iteration t_iteration) {
+      m_native_iterations.push_back(std::move(t_iteration));
+      return *this;
+    }
+
+    /// Adds a function that registers things bound to the engine the module is applied to, such as
+    /// functions that call other functions by name
+    Module &add(std::function<void(chaiscript::detail::Dispatch_Engine &)> t_engine_setup) {
+      m_engine_setups.push_back(std::move(t_engine_setup));
+      return *this;
+    }
+
     Module &add(Proxy_Function f, std::string name) {
       m_funcs.emplace_back(std::move(f), std::move(name));
       return *this;
     }
 
+    /// Adds the function and declares it pure, see chaiscript::pure
+    Module &add(Proxy_Function f, std::string name, Pure_Tag) {
+      f->set_pure();
+      return add(std::move(f), std::move(name));
+    }
+
     Module &add_global_const(Boxed_Value t_bv, std::string t_name) {
       if (!t_bv.is_const()) {
         throw chaiscript::exception::global_non_const();
@@ -152,8 +178,15 @@ namespace chaiscript {
     }
 
     // Add a bit of ChaiScript to eval during module implementation
-    Module &eval(std::string str) {
-      m_evals.push_back(std::move(str));
+    Module &eval(std::string str, std::string filename = "__EVAL__") {
+      m_evals.push_back(Script{std::move(str), std::move(filename), false});
+      return *this;
+    }
+
+    /// Adds ChaiScript to eval like eval() does, and has the engine record the functions it defines as library
+    /// functions, see Dispatch_Engine::is_library_function
+    Module &eval_library(std::string str, std::string filename) {
+      m_evals.push_back(Script{std::move(str), std::move(filename), true});
       return *this;
     }
 
@@ -161,9 +194,13 @@ namespace chaiscript {
     void apply(Eval &t_eval, Engine &t_engine) const {
       apply(m_typeinfos.begin(), m_typeinfos.end(), t_engine);
       apply(m_funcs.begin(), m_funcs.end(), t_engine);
-      apply_eval(m_evals.begin(), m_evals.end(), t_eval);
+      apply_eval(m_evals.begin(), m_evals.end(), t_eval, t_engine);
       apply_single(m_conversions.begin(), m_conversions.end(), t_engine);
+      apply_single(m_native_iterations.begin(), m_native_iterations.end(), t_engine);
       apply_globals(m_globals.begin(), m_globals.end(), t_engine);
+      for (const auto &setup : m_engine_setups) {
+        setup(t_engine);
+      }
     }
 
     bool has_function(const Proxy_Function &new_f, std::string_view name) noexcept {
@@ -173,11 +210,19 @@ namespace chaiscript {
     }
 
   private:
+    struct Script {
+      std::string text;
+      std::string filename;
+      bool library;
+    };
+
     std::vector<std::pair<Type_Info, std::string>> m_typeinfos;
     std::vector<std::pair<Proxy_Function, std::string>> m_funcs;
     std::vector<std::pair<Boxed_Value, std::string>> m_globals;
-    std::vector<std::string> m_evals;
+    std::vector<Script> m_evals;
     std::vector<Type_Conversion> m_conversions;
+    std::vector<Native_Iteration> m_native_iterations;
+    std::vector<std::function<void(chaiscript::detail::Dispatch_Engine &)>> m_engine_setups;
 
     template<typename T, typename InItr>
     static void apply(InItr begin, const InItr end, T &t) {
@@ -207,10 +252,14 @@ namespace chaiscript {
       }
     }
 
-    template<typename T, typename InItr>
-    static void apply_eval(InItr begin, InItr end, T &t) {
+    template<typename T, typename Engine, typename InItr>
+    static void apply_eval(InItr begin, InItr end, T &t, Engine &t_engine) {
       while (begin != end) {
-        t.eval(*begin);
+        if (begin->library) {
+          t_engine.add_library_functions([&]() { t.eval(begin->text, {}, begin->filename); });
+        } else {
+          t.eval(begin->text, {}, begin->filename);
+        }
         ++begin;
       }
     }
@@ -243,6 +292,8 @@ namespace chaiscript {
         return std::vector<Const_Proxy_Function>(m_funcs.begin(), m_funcs.end());
       }
 
+      const std::vector<Proxy_Function> &get_functions() const noexcept { return m_funcs; }
+
       static int calculate_arity(const std::vector<Proxy_Function> &t_funcs) noexcept {
         if (t_funcs.empty()) {
           return -1;
@@ -328,6 +379,8 @@ namespace chaiscript {
       using Stacks = SmallVector<StackData>;
       using Call_Param_List = SmallVector<Boxed_Value>;
       using Call_Params = SmallVector<Call_Param_List>;
+      /// The values a lambda captured, in the order of its capture list
+      using Captures = std::vector<std::pair<std::string, Boxed_Value>>;
 
       Stack_Holder() {
         push_stack();
@@ -339,11 +392,41 @@ namespace chaiscript {
         //        stacks.back().emplace_back(Scope(scope_allocator));
       }
 
-      void push_stack() { stacks.emplace_back(1); }
+      /// Pushes a stack with one empty scope, reusing the memory of one popped earlier if there is any
+      void push_stack() {
+        if (spare_stacks.empty()) {
+          stacks.emplace_back(1);
+        } else {
+          stacks.push_back(std::move(spare_stacks.back()));
+          spare_stacks.pop_back();
+        }
+        captures.emplace_back();
+      }
+
+      void pop_stack() {
+        // taken off first, destroying the values may run script code which uses the stacks
+        auto stack = std::move(stacks.back());
+        stacks.pop_back();
+        const auto stack_captures = std::move(captures.back());
+        captures.pop_back();
+
+        stack.resize(1);
+        stack.front().data.clear();
+        if (spare_stacks.size() < max_spare_stacks) {
+          spare_stacks.push_back(std::move(stack));
+        }
+      }
 
       void push_call_params() { call_params.emplace_back(); }
 
+      /// How many popped stacks are kept for reuse, enough for the nesting of calls in a typical loop
+      static constexpr std::size_t max_spare_stacks = 32;
+
       Stacks stacks;
+      Stacks spare_stacks;
+      /// For each stack, the captures of the lambda it is a call of, if it is one. They are bound to the stack
+      /// as a whole, and a name that is not in any of the stack's scopes is looked for there before the globals
+      SmallVector<std::shared_ptr<const Captures>> captures;
       Call_Params call_params;
 
       int call_depth = 0;
@@ -357,12 +440,16 @@ namespace chaiscript {
       using Scope = utility::QuickFlatMap<std::string, Boxed_Value, str_equal>;
       using StackData = Stack_Holder::StackData;
 
+      /// Functions and globals are keyed by interned names, so that lookups with a name from script text, which
+      /// is interned the first time it reaches them, compare addresses and reuse its hash instead of comparing text
       struct State {
-        utility::QuickFlatMap<std::string, std::shared_ptr<std::vector<Proxy_Function>>, str_equal> m_functions;
-        utility::QuickFlatMap<std::string, Proxy_Function, str_equal> m_function_objects;
-        utility::QuickFlatMap<std::string, Boxed_Value, str_equal> m_boxed_functions;
-        std::map<std::string, Boxed_Value, str_less> m_global_objects;
+        utility::QuickFlatMap<utility::Interned_String, std::shared_ptr<std::vector<Proxy_Function>>, utility::Interned_String::Equal> m_functions;
+        utility::QuickFlatMap<utility::Interned_String, Proxy_Function, utility::Interned_String::Equal> m_function_objects;
+        utility::QuickFlatMap<utility::Interned_String, Boxed_Value, utility::Interned_String::Equal> m_boxed_functions;
+        std::unordered_map<utility::Interned_String, Boxed_Value, utility::Interned_String::Hash, utility::Interned_String::Equal> m_global_objects;
         Type_Name_Map m_types;
+        std::vector<Native_Iteration> m_native_iterations;
+        std::set<Proxy_Function> m_library_functions;
       };
 
       explicit Dispatch_Engine(chaiscript::parser::ChaiScript_Parser_Base &parser)
@@ -380,9 +467,62 @@ namespace chaiscript {
       /// Add a new conversion for upcasting to a base class
       void add(const Type_Conversion &d) { m_conversions.add_conversion(d); }
 
+      /// Add a way for a ranged for to walk a container type natively, replacing any earlier one for the type
+      void add(const Native_Iteration &t_iteration) {
+        chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
+
+        auto &iterations = m_state.m_native_iterations;
+        iterations.erase(std::remove_if(iterations.begin(),
+                                        iterations.end(),
+                                        [&](const Native_Iteration &t_existing) { return t_existing->type().bare_equal(t_iteration->type()); }),
+                         iterations.end());
+        iterations.push_back(t_iteration);
+      }
+
+      /// \returns how a ranged for walks a value of type t_type natively, nullptr if it has to use the range functions
+      Native_Iteration get_native_iteration(const Type_Info &t_type) const {
+        chaiscript::detail::threading::shared_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
+
+        for (const auto &iteration : m_state.m_native_iterations) {
+          if (iteration->type().bare_equal(t_type)) {
+            return iteration;
+          }
+        }
+        return nullptr;
+      }
+
       /// Add a new named Proxy_Function to the system
       void add(const Proxy_Function &f, const std::string &name) { add_function(f, name); }
 
+      /// Runs t_define, and records the functions it adds as library functions
+      template<typename Define>
+      void add_library_functions(const Define &t_define) {
+        std::set<Proxy_Function> existing;
+        for (const auto &func : get_functions()) {
+          existing.insert(func.second);
+        }
+
+        t_define();
+
+        chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
+
+        for (const auto &funcs : get_functions_int()) {
+          for (const auto &func : *funcs.second) {
+            if (existing.count(func) == 0) {
+              m_state.m_library_functions.insert(func);
+            }
+          }
+        }
+      }
+
+      /// True if t_func was defined by a module's library script, such as the standard library's prelude, and so
+      /// is known to the evaluator. A script function of the same name and parameters is not.
+      bool is_library_function(const Proxy_Function &t_func) const {
+        chaiscript::detail::threading::shared_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
+
+        return m_state.m_library_functions.count(t_func) != 0;
+      }
+
       /// Set the value of an object, by name. If the object
       /// is not available in the current scope it is created
       void add(Boxed_Value obj, const std::string &name) {
@@ -412,6 +552,14 @@ namespace chaiscript {
         }
       }
 
+      /// Binds the first object added to the current scope to obj, and drops anything added to the scope after it.
+      /// Lets a loop keep one scope for its variable rather than pushing a new one per iteration
+      void rebind_scope_object(Boxed_Value obj, Stack_Holder &t_holder) {
+        auto &data = get_stack_data(t_holder).back().data;
+        data.erase(data.begin() + 1, data.end());
+        data.front().second = std::move(obj);
+      }
+
       /// Adds a named object to the current scope
       /// \warning This version does not check the validity of the name
       /// it is meant for internal use only
@@ -440,7 +588,7 @@ namespace chaiscript {
         if (m_state.m_global_objects.find(name) != m_state.m_global_objects.end()) {
           throw chaiscript::exception::name_conflict_error(name);
         } else {
-          m_state.m_global_objects.insert(std::make_pair(name, obj));
+          m_state.m_global_objects.emplace(utility::Interned_String(name), obj);
         }
       }
 
@@ -448,14 +596,14 @@ namespace chaiscript {
       Boxed_Value add_global_no_throw(Boxed_Value obj, std::string name) {
         chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
 
-        return m_state.m_global_objects.insert(std::pair{std::move(name), std::move(obj)}).first->second;
+        return m_state.m_global_objects.try_emplace(utility::Interned_String(name), std::move(obj)).first->second;
       }
 
       /// Adds a new global (non-const) shared object, between all the threads
       void add_global(Boxed_Value obj, std::string name) {
         chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
 
-        if (auto result = m_state.m_global_objects.insert(std::pair{std::move(name), std::move(obj)}); !result.second) {
+        if (auto result = m_state.m_global_objects.try_emplace(utility::Interned_String(name), std::move(obj)); !result.second) {
           // insert failed
           throw chaiscript::exception::name_conflict_error(result.first->first);
         }
@@ -464,7 +612,7 @@ namespace chaiscript {
       /// Updates an existing global shared object or adds a new global shared object if not found
       void set_global(Boxed_Value obj, std::string name) {
         chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
-        m_state.m_global_objects.insert_or_assign(std::move(name), std::move(obj));
+        m_state.m_global_objects.insert_or_assign(utility::Interned_String(name), std::move(obj));
       }
 
       /// Adds a new scope to the stack
@@ -495,15 +643,42 @@ namespace chaiscript {
         t_holder.push_stack();
       }
 
-      static void pop_stack(Stack_Holder &t_holder) { t_holder.stacks.pop_back(); }
+      static void pop_stack(Stack_Holder &t_holder) { t_holder.pop_stack(); }
+
+      /// Binds the captures of a lambda to the current stack, which should be a new one for a call of it
+      static void bind_captures(std::shared_ptr<const Stack_Holder::Captures> t_captures, Stack_Holder &t_holder) noexcept {
+        t_holder.captures.back() = std::move(t_captures);
+      }
 
       /// Searches the current stack for an object of the given name
       /// includes a special overload for the _ place holder object to
       /// ensure that it is always in scope.
       Boxed_Value get_object(std::string_view name, std::atomic_uint_fast32_t &t_loc, Stack_Holder &t_holder) const {
+        return find_object(name, [name]() { return name; }, t_loc, t_holder);
+      }
+
+      /// \copydoc get_object(std::string_view, std::atomic_uint_fast32_t &, Stack_Holder &) const
+      Boxed_Value get_object(const utility::Interned_String &name, std::atomic_uint_fast32_t &t_loc, Stack_Holder &t_holder) const {
+        return find_object(name, [&name]() -> const utility::Interned_String & { return name; }, t_loc, t_holder);
+      }
+
+      /// \copydoc get_object(std::string_view, std::atomic_uint_fast32_t &, Stack_Holder &) const
+      /// t_interned is interned from name only if the lookup gets past the locals
+      Boxed_Value get_object(std::string_view name,
+                             const utility::Lazy_Interned_String &t_interned,
+                             std::atomic_uint_fast32_t &t_loc,
+                             Stack_Holder &t_holder) const {
+        return find_object(name, [name, &t_interned]() { return t_interned.get(name); }, t_loc, t_holder);
+      }
+
+    private:
+      /// t_global_name gives the name to look up among the globals and functions, and is not called for a local
+      template<typename Name, typename Global_Name>
+      Boxed_Value find_object(const Name &name, const Global_Name &t_global_name, std::atomic_uint_fast32_t &t_loc, Stack_Holder &t_holder) const {
         enum class Loc : uint_fast32_t {
           located = 0x80000000,
           is_local = 0x40000000,
+          is_capture = 0x20000000,
           stack_mask = 0x0FFF0000,
           loc_mask = 0x0000FFFF
         };
@@ -525,24 +700,39 @@ namespace chaiscript {
             }
           }
 
+          // Is it captured by the lambda this stack is a call of?
+          if (const auto &captures = t_holder.captures.back()) {
+            for (auto c = captures->begin(); c != captures->end(); ++c) {
+              if (c->first == name) {
+                t_loc = static_cast<uint_fast32_t>(std::distance(captures->begin(), c)) | static_cast<uint_fast32_t>(Loc::located)
+                    | static_cast<uint_fast32_t>(Loc::is_capture);
+                return c->second;
+              }
+            }
+          }
+
           t_loc = static_cast<uint_fast32_t>(Loc::located);
         } else if ((loc & static_cast<uint_fast32_t>(Loc::is_local)) != 0u) {
           auto &stack = get_stack_data(t_holder);
 
           return stack[stack.size() - 1 - ((loc & static_cast<uint_fast32_t>(Loc::stack_mask)) >> 16)].at_index(
               loc & static_cast<uint_fast32_t>(Loc::loc_mask));
+        } else if ((loc & static_cast<uint_fast32_t>(Loc::is_capture)) != 0u) {
+          return (*t_holder.captures.back())[loc & static_cast<uint_fast32_t>(Loc::loc_mask)].second;
         }
 
         // Is the value we are looking for a global or function?
+        const auto &global_name = t_global_name();
+
         chaiscript::detail::threading::shared_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
 
-        const auto itr = m_state.m_global_objects.find(name);
+        const auto itr = m_state.m_global_objects.find(global_name);
         if (itr != m_state.m_global_objects.end()) {
           return itr->second;
         }
 
         // no? is it a function object?
-        auto obj = get_function_object_int(name, loc);
+        auto obj = get_function_object_int(global_name, loc);
         if (obj.first != loc) {
           t_loc = uint_fast32_t(obj.first);
         }
@@ -550,6 +740,7 @@ namespace chaiscript {
         return obj.second;
       }
 
+    public:
       /// Registers a new named type
       void add(const Type_Info &ti, const std::string &name) {
         add_global_const(const_var(ti), name + "_type");
@@ -610,6 +801,17 @@ namespace chaiscript {
 
       /// Return a function by name
       std::pair<size_t, std::shared_ptr<std::vector<Proxy_Function>>> get_function(std::string_view t_name, const size_t t_hint) const {
+        return find_function(t_name, t_hint);
+      }
+
+      /// \copydoc get_function(std::string_view, const size_t) const
+      std::pair<size_t, std::shared_ptr<std::vector<Proxy_Function>>> get_function(const utility::Interned_String &t_name, const size_t t_hint) const {
+        return find_function(t_name, t_hint);
+      }
+
+    private:
+      template<typename Name>
+      std::pair<size_t, std::shared_ptr<std::vector<Proxy_Function>>> find_function(const Name &t_name, const size_t t_hint) const {
         chaiscript::detail::threading::shared_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
 
         const auto &funs = get_functions_int();
@@ -621,6 +823,18 @@ namespace chaiscript {
         }
       }
 
+    public:
+
+      /// Changes every time a function is added or the state is replaced, so that call sites
+      /// can tell whether something they cached about the function table is still valid
+      uint_fast32_t function_generation() const noexcept { return m_function_generation; }
+
+      /// Records that an assigned value was taken over instead of cloned, because nothing else referred to it
+      void count_avoided_clone() noexcept { m_avoided_clones.fetch_add(1, std::memory_order_relaxed); }
+
+      /// \returns how many clones on assignment have been avoided so far, for profiling
+      std::size_t avoided_clones() const noexcept { return m_avoided_clones.load(std::memory_order_relaxed); }
+
       /// \returns a function object (Boxed_Value wrapper) if it exists
       /// \throws std::range_error if it does not
       Boxed_Value get_function_object(const std::string &t_name) const {
@@ -632,13 +846,14 @@ namespace chaiscript {
       /// \returns a function object (Boxed_Value wrapper) if it exists
       /// \throws std::range_error if it does not
       /// \warn does not obtain a mutex lock. \sa get_function_object for public version
-      std::pair<size_t, Boxed_Value> get_function_object_int(std::string_view t_name, const size_t t_hint) const {
+      template<typename Name>
+      std::pair<size_t, Boxed_Value> get_function_object_int(const Name &t_name, const size_t t_hint) const {
         const auto &funs = get_boxed_functions_int();
 
         if (const auto itr = funs.find(t_name, t_hint); itr != funs.end()) {
           return std::make_pair(std::distance(funs.begin(), itr), itr->second);
         } else {
-          throw std::range_error("Object not found: " + std::string(t_name));
+          throw std::range_error("Object not found: " + std::string(std::cbegin(t_name), std::cend(t_name)));
         }
       }
 
@@ -664,7 +879,11 @@ namespace chaiscript {
       std::map<std::string, Boxed_Value> get_locals() const {
         auto &stack = get_stack_data();
         auto &scope = stack.front();
-        return std::map<std::string, Boxed_Value>(scope.begin(), scope.end());
+        std::map<std::string, Boxed_Value> retval(scope.begin(), scope.end());
+        if (const auto &captures = m_stack_holder->captures.back()) {
+          retval.insert(captures->begin(), captures->end());
+        }
+        return retval;
       }
 
       /// \brief Sets all of the locals for the current thread state.
@@ -685,7 +904,8 @@ namespace chaiscript {
         const Stack_Holder &s = *m_stack_holder;
 
         // We don't want the current context, but one up if it exists
-        const StackData &stack = (s.stacks.size() == 1) ? (s.stacks.back()) : (s.stacks[s.stacks.size() - 2]);
+        const auto context = (s.stacks.size() == 1) ? (s.stacks.size() - 1) : (s.stacks.size() - 2);
+        const StackData &stack = s.stacks[context];
 
         std::map<std::string, Boxed_Value> retval;
 
@@ -693,6 +913,9 @@ namespace chaiscript {
         for (auto itr = stack.rbegin(); itr != stack.rend(); ++itr) {
           retval.insert(itr->begin(), itr->end());
         }
+        if (const auto &captures = s.captures[context]) {
+          retval.insert(captures->begin(), captures->end());
+        }
 
         // add the global values
         chaiscript::detail::threading::shared_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
@@ -756,7 +979,7 @@ namespace chaiscript {
 #pragma warning(push)
 #pragma warning(disable : 4715)
 #endif
-      Boxed_Value call_member(const std::string &t_name,
+      Boxed_Value call_member(const utility::Interned_String &t_name,
                               std::atomic_uint_fast32_t &t_loc,
                               const Function_Params &params,
                               bool t_has_params,
@@ -851,10 +1074,10 @@ namespace chaiscript {
             try {
               if (is_no_param) {
                 auto tmp_params = params.to_vector();
-                tmp_params.insert(tmp_params.begin() + 1, var(t_name));
+                tmp_params.insert(tmp_params.begin() + 1, var(t_name.str()));
                 return do_attribute_call(2, Function_Params(tmp_params), functions, t_conversions);
               } else {
-                std::array<Boxed_Value, 3> p{params[0], var(t_name), var(std::vector<Boxed_Value>(params.begin() + 1, params.end()))};
+                std::array<Boxed_Value, 3> p{params[0], var(t_name.str()), var(std::vector<Boxed_Value>(params.begin() + 1, params.end()))};
                 return dispatch::dispatch(functions, Function_Params{p}, t_conversions);
               }
             } catch (const dispatch::option_explicit_set &e) {
@@ -882,6 +1105,22 @@ namespace chaiscript {
                                 std::atomic_uint_fast32_t &t_loc,
                                 const Function_Params &params,
                                 const Type_Conversions_State &t_conversions) const {
+        return call_named_function(t_name, t_loc, params, t_conversions);
+      }
+
+      Boxed_Value call_function(const utility::Interned_String &t_name,
+                                std::atomic_uint_fast32_t &t_loc,
+                                const Function_Params &params,
+                                const Type_Conversions_State &t_conversions) const {
+        return call_named_function(t_name, t_loc, params, t_conversions);
+      }
+
+    private:
+      template<typename Name>
+      Boxed_Value call_named_function(const Name &t_name,
+                                      std::atomic_uint_fast32_t &t_loc,
+                                      const Function_Params &params,
+                                      const Type_Conversions_State &t_conversions) const {
         uint_fast32_t loc = t_loc;
         const auto [func_loc, func] = get_function(t_name, loc);
         if (func_loc != loc) {
@@ -890,6 +1129,8 @@ namespace chaiscript {
         return dispatch::dispatch(*func, params, t_conversions);
       }
 
+    public:
+
       /// Dump object info to stdout
       void dump_object(const Boxed_Value &o) const { std::cout << (o.is_const() ? "const " : "") << type_name(o) << '\n'; }
 
@@ -974,16 +1215,16 @@ namespace chaiscript {
         chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
 
         m_state = t_state;
+        ++m_function_generation;
       }
 
       static void save_function_params(Stack_Holder &t_s, std::vector<Boxed_Value> &&t_params) {
-        for (auto &&param : t_params) {
-          t_s.call_params.back().insert(t_s.call_params.back().begin(), std::move(param));
-        }
+        auto &saved = t_s.call_params.back();
+        saved.insert(saved.end(), std::make_move_iterator(t_params.begin()), std::make_move_iterator(t_params.end()));
       }
 
       static void save_function_params(Stack_Holder &t_s, const Function_Params &t_params) {
-        t_s.call_params.back().insert(t_s.call_params.back().begin(), t_params.begin(), t_params.end());
+        t_s.call_params.back().insert(t_s.call_params.back().end(), t_params.begin(), t_params.end());
       }
 
       void save_function_params(std::vector<Boxed_Value> &&t_params) { save_function_params(*m_stack_holder, std::move(t_params)); }
@@ -997,7 +1238,12 @@ namespace chaiscript {
 
         ++t_s.call_depth;
 
-        save_function_params(m_conversions.take_saves(t_saves));
+        // only touch the saves if a conversion actually produced a temporary
+        if (!t_saves.saves.empty()) {
+          auto &saved = t_s.call_params.back();
+          saved.insert(saved.end(), std::make_move_iterator(t_saves.saves.begin()), std::make_move_iterator(t_saves.saves.end()));
+          t_saves.saves.clear();
+        }
       }
 
       void pop_function_call(Stack_Holder &t_s, Type_Conversions::Conversion_Saves &t_saves) {
@@ -1113,11 +1359,13 @@ namespace chaiscript {
       /// Implementation detail for adding a function.
       /// \throws exception::name_conflict_error if there's a function matching the given one being added
       void add_function(const Proxy_Function &t_f, const std::string &t_name) {
+        const utility::Interned_String name(t_name);
+
         chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
 
         Proxy_Function new_func = [&]() -> Proxy_Function {
           auto &funcs = get_functions_int();
-          auto itr = funcs.find(t_name);
+          auto itr = funcs.find(name);
 
           if (itr != funcs.end()) {
             auto vec = *itr->second;
@@ -1138,18 +1386,19 @@ namespace chaiscript {
             // to allow for automatic arithmetic type conversions
             std::vector<Proxy_Function> vec;
             vec.push_back(t_f);
-            funcs.insert(std::pair{t_name, std::make_shared<std::vector<Proxy_Function>>(vec)});
+            funcs.insert(std::pair{name, std::make_shared<std::vector<Proxy_Function>>(vec)});
             return std::make_shared<Dispatch_Function>(std::move(vec));
           } else {
             auto vec = std::make_shared<std::vector<Proxy_Function>>();
             vec->push_back(t_f);
-            funcs.insert(std::pair{t_name, vec});
+            funcs.insert(std::pair{name, vec});
             return t_f;
           }
         }();
 
-        get_boxed_functions_int().insert_or_assign(t_name, const_var(new_func));
-        get_function_objects_int().insert_or_assign(t_name, std::move(new_func));
+        get_boxed_functions_int().insert_or_assign(name, const_var(new_func));
+        get_function_objects_int().insert_or_assign(name, std::move(new_func));
+        ++m_function_generation;
       }
 
       mutable chaiscript::detail::threading::shared_mutex m_mutex;
@@ -1159,6 +1408,8 @@ namespace chaiscript {
       std::reference_wrapper<parser::ChaiScript_Parser_Base> m_parser;
 
       mutable std::atomic_uint_fast32_t m_method_missing_loc = {0};
+      std::atomic_uint_fast32_t m_function_generation = {0};
+      std::atomic_size_t m_avoided_clones = {0};
 
       State m_state;
     };
@@ -1189,10 +1440,20 @@ namespace chaiscript {
         m_engine.get().add_object(t_name, std::move(obj), m_stack_holder.get());
       }
 
+      void rebind_scope_object(Boxed_Value obj) const { m_engine.get().rebind_scope_object(std::move(obj), m_stack_holder.get()); }
+
       Boxed_Value get_object(std::string_view t_name, std::atomic_uint_fast32_t &t_loc) const {
         return m_engine.get().get_object(t_name, t_loc, m_stack_holder.get());
       }
 
+      Boxed_Value get_object(const utility::Interned_String &t_name, std::atomic_uint_fast32_t &t_loc) const {
+        return m_engine.get().get_object(t_name, t_loc, m_stack_holder.get());
+      }
+
+      Boxed_Value get_object(std::string_view t_name, const utility::Lazy_Interned_String &t_interned, std::atomic_uint_fast32_t &t_loc) const {
+        return m_engine.get().get_object(t_name, t_interned, t_loc, m_stack_holder.get());
+      }
+
     private:
       std::reference_wrapper<Dispatch_Engine> m_engine;
       std::reference_wrapper<Stack_Holder> m_stack_holder;
@@ -10,10 +10,18 @@
 #ifndef CHAISCRIPT_DYNAMIC_OBJECT_HPP_
 #define CHAISCRIPT_DYNAMIC_OBJECT_HPP_
 
+#include <atomic>
+#include <cstddef>
+#include <deque>
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <utility>
+#include <vector>
 
+#include "../chaiscript_threading.hpp"
+#include "../utility/interned_string.hpp"
 #include "boxed_value.hpp"
 
 namespace chaiscript {
@@ -35,14 +43,154 @@ namespace chaiscript {
       ~option_explicit_set() noexcept override = default;
     };
 
+    /// The layout of a Dynamic_Object: which attribute lives in which slot. Shared shapes are immutable.
+    /// Every class name has a root shape, and adding an attribute moves an object to the child shape for
+    /// that name. Objects of one class that gain their attributes in the same order therefore share a shape,
+    /// and an attribute has the same slot in all of them.
+    ///
+    /// Shared shapes live for the whole process, so there are at most max_shared_shapes of them. An object
+    /// that would need one more, or that gets more than max_shared_attrs attributes, moves to a dictionary
+    /// shape of its own, which it adds any further attributes to in place.
+    ///
+    /// Attribute names are hashed, not interned, since scripts can make them up at runtime with get_attr.
+    /// A name from script text is interned once it is looked up, so later lookups reuse its cached hash.
+    class Dynamic_Object_Shape {
+    public:
+      static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+      /// Objects with more attributes than this have a dictionary shape
+      static constexpr std::size_t max_shared_attrs = 32;
+
+      /// The most shared shapes, roots included, there can be across all class names
+      static constexpr std::size_t max_shared_shapes = 4096;
+
+      /// \returns the shared empty shape for objects of type t_type_name, or nullptr if there is no room for
+      ///          another shared shape
+      static std::shared_ptr<const Dynamic_Object_Shape> root(const std::string &t_type_name) {
+        static chaiscript::detail::threading::shared_mutex mutex;
+        static std::map<std::string, std::shared_ptr<const Dynamic_Object_Shape>, std::less<>> roots;
+
+        {
+          chaiscript::detail::threading::shared_lock<chaiscript::detail::threading::shared_mutex> l(mutex);
+          if (const auto itr = roots.find(t_type_name); itr != roots.end()) {
+            return itr->second;
+          }
+        }
+
+        chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(mutex);
+        if (const auto itr = roots.find(t_type_name); itr != roots.end()) {
+          return itr->second;
+        }
+        if (!reserve_shared_shape()) {
+          return nullptr;
+        }
+        return roots.emplace(t_type_name, std::make_shared<const Dynamic_Object_Shape>()).first->second;
+      }
+
+      Dynamic_Object_Shape() = default;
+
+      /// An unshared copy of the layout of t_other, without its children
+      Dynamic_Object_Shape(const Dynamic_Object_Shape &t_other)
+          : m_names(t_other.m_names)
+          , m_index(t_other.m_index) {
+      }
+
+      Dynamic_Object_Shape(const Dynamic_Object_Shape &t_parent, const std::string &t_attr_name)
+          : Dynamic_Object_Shape(t_parent) {
+        add_attr(t_attr_name);
+      }
+
+      Dynamic_Object_Shape &operator=(const Dynamic_Object_Shape &) = delete;
+
+      /// \returns the slot of t_attr_name, or npos if this shape does not have it
+      std::size_t index_of(const std::string &t_attr_name) const noexcept { return find_index(t_attr_name); }
+
+      /// \copydoc index_of(const std::string &) const
+      std::size_t index_of(const utility::Interned_String &t_attr_name) const noexcept { return find_index(t_attr_name); }
+
+      /// \returns the shared shape reached by adding t_attr_name to this shared shape, or nullptr if the
+      ///          object should move to a dictionary shape instead
+      std::shared_ptr<const Dynamic_Object_Shape> with_attr(const std::string &t_attr_name) const {
+        if (m_names.size() >= max_shared_attrs) {
+          return nullptr;
+        }
+
+        {
+          chaiscript::detail::threading::shared_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
+          if (const auto itr = m_transitions.find(t_attr_name); itr != m_transitions.end()) {
+            return itr->second;
+          }
+        }
+
+        chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(m_mutex);
+        if (const auto itr = m_transitions.find(t_attr_name); itr != m_transitions.end()) {
+          return itr->second;
+        }
+        if (!reserve_shared_shape()) {
+          return nullptr;
+        }
+        return m_transitions.emplace(t_attr_name, std::make_shared<const Dynamic_Object_Shape>(*this, t_attr_name)).first->second;
+      }
+
+      /// Gives t_attr_name the next slot. Only for a dictionary shape, which belongs to a single object
+      void add_attr(const std::string &t_attr_name) {
+        m_index.emplace(t_attr_name, m_names.size());
+        m_names.push_back(t_attr_name);
+      }
+
+      const std::vector<std::string> &attr_names() const noexcept { return m_names; }
+
+    private:
+      /// Counts one more shared shape, if there is room for it
+      static bool reserve_shared_shape() noexcept {
+        static std::atomic_size_t count = {0};
+        if (count.fetch_add(1) < max_shared_shapes) {
+          return true;
+        } else {
+          --count;
+          return false;
+        }
+      }
+
+      template<typename Name>
+      std::size_t find_index(const Name &t_attr_name) const noexcept {
+        if (const auto itr = m_index.find(t_attr_name); itr != m_index.end()) {
+          return itr->second;
+        } else {
+          return npos;
+        }
+      }
+
+      template<typename Value>
+      using Name_Map = std::unordered_map<std::string, Value, utility::Interned_String::Hash, utility::Interned_String::Equal>;
+
+      std::vector<std::string> m_names;
+      Name_Map<std::size_t> m_index;
+
+      mutable chaiscript::detail::threading::shared_mutex m_mutex;
+      mutable Name_Map<std::shared_ptr<const Dynamic_Object_Shape>> m_transitions;
+    };
+
     class Dynamic_Object {
     public:
       explicit Dynamic_Object(std::string t_type_name)
           : m_type_name(std::move(t_type_name))
           , m_option_explicit(false) {
+        start_shape();
       }
 
-      Dynamic_Object() = default;
+      Dynamic_Object() { start_shape(); }
+
+      /// A copy with a dictionary shape gets a dictionary shape of its own
+      Dynamic_Object(const Dynamic_Object &t_other)
+          : m_type_name(t_other.m_type_name)
+          , m_option_explicit(t_other.m_option_explicit)
+          , m_dictionary(t_other.m_dictionary ? std::make_shared<Dynamic_Object_Shape>(*t_other.m_dictionary) : nullptr)
+          , m_shape(m_dictionary ? m_dictionary : t_other.m_shape)
+          , m_slots(t_other.m_slots) {
+      }
+
+      Dynamic_Object(Dynamic_Object &&) = default;
 
       bool is_explicit() const noexcept { return m_option_explicit; }
 
@@ -55,21 +203,36 @@ namespace chaiscript {
       Boxed_Value &operator[](const std::string &t_attr_name) { return get_attr(t_attr_name); }
 
       const Boxed_Value &get_attr(const std::string &t_attr_name) const {
-        auto a = m_attrs.find(t_attr_name);
-
-        if (a != m_attrs.end()) {
-          return a->second;
+        if (const auto index = m_shape->index_of(t_attr_name); index != Dynamic_Object_Shape::npos) {
+          return m_slots[index];
         } else {
           throw std::range_error("Attr not found '" + t_attr_name + "' and cannot be added to const obj");
         }
       }
 
-      bool has_attr(const std::string &t_attr_name) const { return m_attrs.find(t_attr_name) != m_attrs.end(); }
+      bool has_attr(const std::string &t_attr_name) const { return m_shape->index_of(t_attr_name) != Dynamic_Object_Shape::npos; }
 
-      Boxed_Value &get_attr(const std::string &t_attr_name) { return m_attrs[t_attr_name]; }
+      Boxed_Value &get_attr(const std::string &t_attr_name) {
+        if (const auto index = m_shape->index_of(t_attr_name); index != Dynamic_Object_Shape::npos) {
+          return m_slots[index];
+        }
+
+        if (!m_dictionary) {
+          if (auto next = m_shape->with_attr(t_attr_name)) {
+            m_shape = std::move(next);
+            return m_slots.emplace_back();
+          }
+
+          m_dictionary = std::make_shared<Dynamic_Object_Shape>(*m_shape);
+          m_shape = m_dictionary;
+        }
+
+        m_dictionary->add_attr(t_attr_name);
+        return m_slots.emplace_back();
+      }
 
       Boxed_Value &method_missing(const std::string &t_method_name) {
-        if (m_option_explicit && m_attrs.find(t_method_name) == m_attrs.end()) {
+        if (m_option_explicit && !has_attr(t_method_name)) {
           throw option_explicit_set(t_method_name);
         }
 
@@ -77,20 +240,50 @@ namespace chaiscript {
       }
 
       const Boxed_Value &method_missing(const std::string &t_method_name) const {
-        if (m_option_explicit && m_attrs.find(t_method_name) == m_attrs.end()) {
+        if (m_option_explicit && !has_attr(t_method_name)) {
           throw option_explicit_set(t_method_name);
         }
 
         return get_attr(t_method_name);
       }
 
-      std::map<std::string, Boxed_Value> get_attrs() const { return m_attrs; }
+      std::map<std::string, Boxed_Value> get_attrs() const {
+        std::map<std::string, Boxed_Value> attrs;
+        const auto &names = m_shape->attr_names();
+        for (std::size_t i = 0; i < names.size(); ++i) {
+          attrs.emplace(names[i], m_slots[i]);
+        }
+        return attrs;
+      }
+
+      /// The current layout of this object. It changes whenever an attribute is added, unless it is a dictionary
+      /// shape, which only ever gains slots
+      const Dynamic_Object_Shape *get_shape() const noexcept { return m_shape.get(); }
+
+      const std::shared_ptr<const Dynamic_Object_Shape> &get_shape_ptr() const noexcept { return m_shape; }
+
+      /// Direct access to an attribute by its slot in get_shape(), no checking is performed
+      const Boxed_Value &get_slot(const std::size_t t_index) const noexcept { return m_slots[t_index]; }
 
     private:
+      void start_shape() {
+        m_shape = Dynamic_Object_Shape::root(m_type_name);
+        if (!m_shape) {
+          m_dictionary = std::make_shared<Dynamic_Object_Shape>();
+          m_shape = m_dictionary;
+        }
+      }
+
       const std::string m_type_name = "";
       bool m_option_explicit = false;
 
-      std::map<std::string, Boxed_Value> m_attrs;
+      /// This object's own shape, once it has moved to a dictionary shape
+      std::shared_ptr<Dynamic_Object_Shape> m_dictionary;
+      std::shared_ptr<const Dynamic_Object_Shape> m_shape;
+
+      // a deque never moves existing elements on growth, so references handed
+      // out by get_attr stay valid when attributes are added later
+      std::deque<Boxed_Value> m_slots;
     };
 
   } // namespace dispatch
@@ -10,6 +10,7 @@
 #ifndef CHAISCRIPT_FUNCTION_PARAMS_HPP
 #define CHAISCRIPT_FUNCTION_PARAMS_HPP
 
+#include "../utility/stack_vector.hpp"
 #include "boxed_value.hpp"
 
 namespace chaiscript {
@@ -36,6 +37,12 @@ namespace chaiscript {
         , m_end(&a.front() + Size) {
     }
 
+    template<size_t Size>
+    explicit Function_Params(const utility::Stack_Vector<Boxed_Value, Size> &sv)
+        : m_begin(sv.begin())
+        , m_end(sv.end()) {
+    }
+
     [[nodiscard]] constexpr const Boxed_Value &operator[](const std::size_t t_i) const noexcept { return m_begin[t_i]; }
 
     [[nodiscard]] constexpr const Boxed_Value *begin() const noexcept { return m_begin; }
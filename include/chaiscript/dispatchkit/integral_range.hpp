@@ -0,0 +1,129 @@
+// This file is distributed under the BSD License.
+// See "license.txt" for details.
+// Copyright 2009-2012, Jonathan Turner (jonathan@emptycrate.com)
+// Copyright 2009-2018, Jason Turner (jason@emptycrate.com)
+// http://www.chaiscript.com
+
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#ifndef CHAISCRIPT_INTEGRAL_RANGE_HPP_
+#define CHAISCRIPT_INTEGRAL_RANGE_HPP_
+
+#include <cstddef>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <vector>
+
+#include "boxed_number.hpp"
+#include "boxed_value.hpp"
+#include "type_info.hpp"
+
+namespace chaiscript::dispatch {
+  /// The integers from a first to a last value, inclusive, handed out one at a time instead of held in a
+  /// container. This is what a range literal `[a..b]` evaluates to where it is consumed right away, see
+  /// eval::Inline_Range_AST_Node. Values have the type of the bounds.
+  class Integral_Range {
+  public:
+    /// \returns the range from t_first to t_last if both are of the same integral type, nothing otherwise
+    static std::optional<Integral_Range> from_bounds(const Boxed_Value &t_first, const Boxed_Value &t_last) {
+      const auto &type = t_first.get_type_info();
+      if (!type.bare_equal(t_last.get_type_info())) {
+        return std::nullopt;
+      }
+
+      if (type.bare_equal(user_type<int>()) || type.bare_equal(user_type<long>()) || type.bare_equal(user_type<long long>())) {
+        const auto first = Boxed_Number(t_first).get_as<long long>();
+        const auto last = Boxed_Number(t_last).get_as<long long>();
+        return make(type, static_cast<unsigned long long>(first), static_cast<unsigned long long>(last), first <= last);
+      } else if (type.bare_equal(user_type<unsigned int>()) || type.bare_equal(user_type<unsigned long>())
+                 || type.bare_equal(user_type<unsigned long long>())) {
+        const auto first = Boxed_Number(t_first).get_as<unsigned long long>();
+        const auto last = Boxed_Number(t_last).get_as<unsigned long long>();
+        return make(type, first, last, first <= last);
+      } else {
+        return std::nullopt;
+      }
+    }
+
+    bool empty() const noexcept { return m_size == 0; }
+
+    std::size_t size() const noexcept { return static_cast<std::size_t>(m_size); }
+
+    void pop_front() {
+      if (empty()) {
+        throw std::range_error("Range empty");
+      }
+      ++m_first;
+      --m_size;
+    }
+
+    void pop_back() {
+      if (empty()) {
+        throw std::range_error("Range empty");
+      }
+      --m_size;
+    }
+
+    Boxed_Value front() const {
+      if (empty()) {
+        throw std::range_error("Range empty");
+      }
+      return value(m_first);
+    }
+
+    Boxed_Value back() const {
+      if (empty()) {
+        throw std::range_error("Range empty");
+      }
+      return value(m_first + m_size - 1);
+    }
+
+    /// \returns the value at t_index, counting from the front
+    /// \throws std::out_of_range if there is no such value
+    Boxed_Value at(std::size_t t_index) const {
+      if (t_index >= m_size) {
+        throw std::out_of_range("Integral_Range index out of range");
+      }
+      return value(m_first + t_index);
+    }
+
+    /// \returns the values left in the range as a Vector, which is what `generate_range` would have made
+    std::vector<Boxed_Value> to_vector() const {
+      std::vector<Boxed_Value> retval;
+      retval.reserve(size());
+      for (unsigned long long i = 0; i < m_size; ++i) {
+        retval.push_back(value(m_first + i));
+      }
+      return retval;
+    }
+
+  private:
+    Integral_Range(const Type_Info &t_type, unsigned long long t_first, unsigned long long t_size) noexcept
+        : m_type(t_type)
+        , m_first(t_first)
+        , m_size(t_size) {
+    }
+
+    static std::optional<Integral_Range> make(const Type_Info &t_type, unsigned long long t_first, unsigned long long t_last, bool t_ordered) {
+      if (!t_ordered) {
+        return Integral_Range(t_type, t_first, 0);
+      } else if (t_last - t_first == std::numeric_limits<unsigned long long>::max()) {
+        // the size does not fit
+        return std::nullopt;
+      } else {
+        return Integral_Range(t_type, t_first, t_last - t_first + 1);
+      }
+    }
+
+    /// The value t_bits stands for, converted back to the type of the bounds
+    Boxed_Value value(unsigned long long t_bits) const { return Boxed_Number(static_cast<long long>(t_bits)).get_as(m_type).bv; }
+
+    Type_Info m_type;
+    unsigned long long m_first;
+    unsigned long long m_size;
+  };
+} // namespace chaiscript::dispatch
+
+#endif
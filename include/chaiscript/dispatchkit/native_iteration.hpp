@@ -0,0 +1,106 @@
+// This file is distributed under the BSD License.
+// See "license.txt" for details.
+// Copyright 2009-2012, Jonathan Turner (jonathan@emptycrate.com)
+// Copyright 2009-2018, Jason Turner (jason@emptycrate.com)
+// http://www.chaiscript.com
+
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#ifndef CHAISCRIPT_NATIVE_ITERATION_HPP_
+#define CHAISCRIPT_NATIVE_ITERATION_HPP_
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "boxed_cast.hpp"
+#include "boxed_value.hpp"
+#include "type_info.hpp"
+
+namespace chaiscript {
+  namespace detail {
+    /// Walks the elements of one C++ container type for a ranged `for`, see chaiscript::native_iteration
+    class Native_Iteration_Base {
+    public:
+      virtual ~Native_Iteration_Base() = default;
+
+      /// The container type this walks
+      const Type_Info &type() const noexcept { return m_type; }
+
+      /// Calls t_visit with each element of t_container, in order. An exception t_visit throws stops the walk.
+      virtual void for_each(const Boxed_Value &t_container, const std::function<void(Boxed_Value)> &t_visit) const = 0;
+
+    protected:
+      explicit Native_Iteration_Base(const Type_Info &t_type) noexcept
+          : m_type(t_type) {
+      }
+
+    private:
+      Type_Info m_type;
+    };
+
+    template<class, class = std::void_t<>>
+    struct is_const_iterable : std::false_type {
+    };
+
+    template<class Container>
+    struct is_const_iterable<Container, std::void_t<decltype(std::declval<const Container &>().begin() != std::declval<const Container &>().end())>>
+        : std::true_type {
+    };
+
+    template<typename Container>
+    class Native_Iteration_Impl final : public Native_Iteration_Base {
+    public:
+      Native_Iteration_Impl() noexcept
+          : Native_Iteration_Base(user_type<Container>()) {
+      }
+
+      void for_each(const Boxed_Value &t_container, const std::function<void(Boxed_Value)> &t_visit) const override {
+        if constexpr (is_const_iterable<Container>::value) {
+          if (t_container.is_const()) {
+            walk(boxed_cast<const Container &>(t_container), t_visit);
+            return;
+          }
+        }
+
+        // one that can only be walked while it is not const, such as a stream, throws bad_boxed_cast when it is
+        walk(boxed_cast<Container &>(t_container), t_visit);
+      }
+
+    private:
+      template<typename C>
+      static void walk(C &t_container, const std::function<void(Boxed_Value)> &t_visit) {
+        for (auto &&elem : t_container) {
+          if constexpr (std::is_same_v<std::decay_t<decltype(elem)>, Boxed_Value>) {
+            t_visit(elem);
+          } else {
+            // elements are bound by reference, as the range functions hand them out
+            t_visit(Boxed_Value(std::ref(elem)));
+          }
+        }
+      }
+    };
+  } // namespace detail
+
+  using Native_Iteration = std::shared_ptr<const detail::Native_Iteration_Base>;
+
+  /// \brief Lets a ranged `for` over a Container walk it directly with begin() and end(), instead of calling
+  ///        the script functions `range`, `empty`, `front` and `pop_front` for every element
+  ///
+  /// The standard library registers this for the containers it binds, for instance with vector_type.
+  /// Elements that are not Boxed_Values are bound to the loop variable by reference.
+  ///
+  /// \b Example:
+  /// \code
+  /// chai.add(chaiscript::user_type<std::vector<double>>(), "DoubleVector");
+  /// chai.add(chaiscript::native_iteration<std::vector<double>>());
+  /// \endcode
+  template<typename Container>
+  Native_Iteration native_iteration() {
+    return std::make_shared<const detail::Native_Iteration_Impl<Container>>();
+  }
+} // namespace chaiscript
+
+#endif
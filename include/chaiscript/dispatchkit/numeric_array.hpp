@@ -0,0 +1,218 @@
+// This file is distributed under the BSD License.
+// See "license.txt" for details.
+// Copyright 2009-2012, Jonathan Turner (jonathan@emptycrate.com)
+// Copyright 2009-2018, Jason Turner (jason@emptycrate.com)
+// http://www.chaiscript.com
+
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#ifndef CHAISCRIPT_NUMERIC_ARRAY_HPP_
+#define CHAISCRIPT_NUMERIC_ARRAY_HPP_
+
+#include <array>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "../chaiscript_defines.hpp"
+#include "boxed_number.hpp"
+#include "boxed_value.hpp"
+
+/// \file
+/// The work behind the typed numeric arrays scripts get from bootstrap::standard_library::numeric_array_type.
+/// An array is a std::vector of a single arithmetic type, so its elements sit next to each other unboxed. Every
+/// loop here runs over plain pointers with no calls or branches in its body, which is the form compilers turn
+/// into vector instructions.
+
+namespace chaiscript::dispatch::numeric_array {
+  /// The number of running results a reduction keeps. Adding each element to one total makes every addition
+  /// wait on the one before, and a compiler may not reorder floating point additions to break that chain, so
+  /// the elements are dealt out among this many totals instead, which fill the lanes of a vector register.
+  /// Floating point sums can therefore differ in the last places from adding the elements strictly in order.
+  inline constexpr std::size_t lanes = 8;
+
+  template<typename T>
+  void check_same_size(const std::vector<T> &t_lhs, const std::vector<T> &t_rhs) {
+    if (t_lhs.size() != t_rhs.size()) {
+      throw std::range_error("Arrays differ in size");
+    }
+  }
+
+  /// Integer division by zero is checked once, up front, so the dividing loop stays free of branches
+  template<typename T>
+  void check_divisors(const T *t_begin, const T *t_end) {
+#ifndef CHAISCRIPT_NO_PROTECT_DIVIDEBYZERO
+    if constexpr (std::is_integral_v<T>) {
+      for (; t_begin != t_end; ++t_begin) {
+        if (*t_begin == 0) {
+          throw chaiscript::exception::arithmetic_error("divide by zero");
+        }
+      }
+    }
+#endif
+  }
+
+  /// t_out[i] = t_oper(t_lhs[i], t_rhs[i])
+  template<typename T, typename Oper>
+  void apply(T *t_out, const T *t_lhs, const T *t_rhs, const std::size_t t_size, Oper t_oper) noexcept {
+    for (std::size_t i = 0; i < t_size; ++i) {
+      t_out[i] = t_oper(t_lhs[i], t_rhs[i]);
+    }
+  }
+
+  /// t_out[i] = t_oper(t_lhs[i], t_rhs)
+  template<typename T, typename Oper>
+  void apply(T *t_out, const T *t_lhs, const T t_rhs, const std::size_t t_size, Oper t_oper) noexcept {
+    for (std::size_t i = 0; i < t_size; ++i) {
+      t_out[i] = t_oper(t_lhs[i], t_rhs);
+    }
+  }
+
+  /// t_out[i] = t_oper(t_lhs, t_rhs[i])
+  template<typename T, typename Oper>
+  void apply(T *t_out, const T t_lhs, const T *t_rhs, const std::size_t t_size, Oper t_oper) noexcept {
+    for (std::size_t i = 0; i < t_size; ++i) {
+      t_out[i] = t_oper(t_lhs, t_rhs[i]);
+    }
+  }
+
+  template<typename T, typename Oper>
+  std::vector<T> elementwise(const std::vector<T> &t_lhs, const std::vector<T> &t_rhs, Oper t_oper) {
+    check_same_size(t_lhs, t_rhs);
+    std::vector<T> retval(t_lhs.size());
+    apply(retval.data(), t_lhs.data(), t_rhs.data(), retval.size(), t_oper);
+    return retval;
+  }
+
+  template<typename T, typename Oper>
+  std::vector<T> elementwise(const std::vector<T> &t_lhs, const T t_rhs, Oper t_oper) {
+    std::vector<T> retval(t_lhs.size());
+    apply(retval.data(), t_lhs.data(), t_rhs, retval.size(), t_oper);
+    return retval;
+  }
+
+  template<typename T, typename Oper>
+  std::vector<T> elementwise(const T t_lhs, const std::vector<T> &t_rhs, Oper t_oper) {
+    std::vector<T> retval(t_rhs.size());
+    apply(retval.data(), t_lhs, t_rhs.data(), retval.size(), t_oper);
+    return retval;
+  }
+
+  /// t_lhs[i] = t_oper(t_lhs[i], t_rhs[i]), in place
+  template<typename T, typename Oper>
+  std::vector<T> &assign_elementwise(std::vector<T> &t_lhs, const std::vector<T> &t_rhs, Oper t_oper) {
+    check_same_size(t_lhs, t_rhs);
+    apply(t_lhs.data(), t_lhs.data(), t_rhs.data(), t_lhs.size(), t_oper);
+    return t_lhs;
+  }
+
+  template<typename T, typename Oper>
+  std::vector<T> &assign_elementwise(std::vector<T> &t_lhs, const T t_rhs, Oper t_oper) {
+    apply(t_lhs.data(), t_lhs.data(), t_rhs, t_lhs.size(), t_oper);
+    return t_lhs;
+  }
+
+  /// Folds t_size elements into lanes running results with t_step(result, i), then folds those together with t_combine
+  template<typename T, typename Step, typename Combine>
+  T reduce(const T t_initial, const std::size_t t_size, Step t_step, Combine t_combine) noexcept {
+    std::array<T, lanes> results;
+    results.fill(t_initial);
+
+    const std::size_t whole_blocks = t_size - t_size % lanes;
+    std::size_t i = 0;
+    for (; i < whole_blocks; i += lanes) {
+      for (std::size_t lane = 0; lane < lanes; ++lane) {
+        results[lane] = t_step(results[lane], i + lane);
+      }
+    }
+    for (; i < t_size; ++i) {
+      results[0] = t_step(results[0], i);
+    }
+
+    T retval = results[0];
+    for (std::size_t lane = 1; lane < lanes; ++lane) {
+      retval = t_combine(retval, results[lane]);
+    }
+    return retval;
+  }
+
+  template<typename T>
+  T sum(const std::vector<T> &t_array) noexcept {
+    const T *data = t_array.data();
+    const auto add = [](const T t_lhs, const T t_rhs) { return static_cast<T>(t_lhs + t_rhs); };
+    return reduce(T{0}, t_array.size(), [data, add](const T t_result, const std::size_t t_index) { return add(t_result, data[t_index]); }, add);
+  }
+
+  template<typename T>
+  T dot(const std::vector<T> &t_lhs, const std::vector<T> &t_rhs) {
+    check_same_size(t_lhs, t_rhs);
+    const T *lhs = t_lhs.data();
+    const T *rhs = t_rhs.data();
+    return reduce(
+        T{0},
+        t_lhs.size(),
+        [lhs, rhs](const T t_result, const std::size_t t_index) { return static_cast<T>(t_result + lhs[t_index] * rhs[t_index]); },
+        [](const T t_first, const T t_second) { return static_cast<T>(t_first + t_second); });
+  }
+
+  /// \throws std::range_error if t_array is empty
+  template<typename T>
+  T min(const std::vector<T> &t_array) {
+    if (t_array.empty()) {
+      throw std::range_error("Container empty");
+    }
+    const T *data = t_array.data();
+    const auto lesser = [](const T t_lhs, const T t_rhs) { return t_rhs < t_lhs ? t_rhs : t_lhs; };
+    return reduce(data[0], t_array.size(), [data, lesser](const T t_result, const std::size_t t_index) { return lesser(t_result, data[t_index]); }, lesser);
+  }
+
+  /// \throws std::range_error if t_array is empty
+  template<typename T>
+  T max(const std::vector<T> &t_array) {
+    if (t_array.empty()) {
+      throw std::range_error("Container empty");
+    }
+    const T *data = t_array.data();
+    const auto greater = [](const T t_lhs, const T t_rhs) { return t_lhs < t_rhs ? t_rhs : t_lhs; };
+    return reduce(data[0], t_array.size(), [data, greater](const T t_result, const std::size_t t_index) { return greater(t_result, data[t_index]); }, greater);
+  }
+
+  /// A copy of the elements from t_begin up to, but not including, t_end
+  /// \throws std::out_of_range unless t_begin <= t_end <= size
+  template<typename T>
+  std::vector<T> slice(const std::vector<T> &t_array, const std::size_t t_begin, const std::size_t t_end) {
+    if (t_begin > t_end || t_end > t_array.size()) {
+      throw std::out_of_range("Slice out of range");
+    }
+    return std::vector<T>(t_array.begin() + static_cast<std::ptrdiff_t>(t_begin), t_array.begin() + static_cast<std::ptrdiff_t>(t_end));
+  }
+
+  /// The array holding the numbers in t_vec, each converted as a script conversion would
+  /// \throws std::invalid_argument if an element is not a number
+  template<typename T>
+  std::vector<T> from_vector(const std::vector<Boxed_Value> &t_vec) {
+    std::vector<T> retval;
+    retval.reserve(t_vec.size());
+    for (const auto &bv : t_vec) {
+      if (!bv.get_type_info().is_arithmetic() || bv.get_type_info().bare_equal(user_type<bool>())) {
+        throw std::invalid_argument("Array element is not a number");
+      }
+      retval.push_back(Boxed_Number(bv).get_as<T>());
+    }
+    return retval;
+  }
+
+  template<typename T>
+  std::vector<Boxed_Value> to_vector(const std::vector<T> &t_array) {
+    std::vector<Boxed_Value> retval;
+    retval.reserve(t_array.size());
+    for (const auto value : t_array) {
+      retval.push_back(Boxed_Value(value));
+    }
+    return retval;
+  }
+} // namespace chaiscript::dispatch::numeric_array
+
+#endif
@@ -82,102 +82,102 @@ namespace chaiscript::bootstrap::operators {
 
   template<typename T>
   void equal(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs == rhs; }), "==");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs == rhs; }, chaiscript::pure), "==");
   }
 
   template<typename T>
   void greater_than(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs > rhs; }), ">");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs > rhs; }, chaiscript::pure), ">");
   }
 
   template<typename T>
   void greater_than_equal(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs >= rhs; }), ">=");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs >= rhs; }, chaiscript::pure), ">=");
   }
 
   template<typename T>
   void less_than(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs < rhs; }), "<");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs < rhs; }, chaiscript::pure), "<");
   }
 
   template<typename T>
   void less_than_equal(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs <= rhs; }), "<=");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs <= rhs; }, chaiscript::pure), "<=");
   }
 
   template<typename T>
   void logical_compliment(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs) { return !lhs; }), "!");
+    m.add(chaiscript::fun([](const T &lhs) { return !lhs; }, chaiscript::pure), "!");
   }
 
   template<typename T>
   void not_equal(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs != rhs; }), "!=");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs != rhs; }, chaiscript::pure), "!=");
   }
 
   template<typename T>
   void addition(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs + rhs; }), "+");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs + rhs; }, chaiscript::pure), "+");
   }
 
   template<typename T>
   void unary_plus(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs) { return +lhs; }), "+");
+    m.add(chaiscript::fun([](const T &lhs) { return +lhs; }, chaiscript::pure), "+");
   }
 
   template<typename T>
   void subtraction(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs - rhs; }), "-");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs - rhs; }, chaiscript::pure), "-");
   }
 
   template<typename T>
   void unary_minus(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs) { return -lhs; }), "-");
+    m.add(chaiscript::fun([](const T &lhs) { return -lhs; }, chaiscript::pure), "-");
   }
 
   template<typename T>
   void bitwise_and(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs & rhs; }), "&");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs & rhs; }, chaiscript::pure), "&");
   }
 
   template<typename T>
   void bitwise_compliment(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs) { return ~lhs; }), "~");
+    m.add(chaiscript::fun([](const T &lhs) { return ~lhs; }, chaiscript::pure), "~");
   }
 
   template<typename T>
   void bitwise_xor(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs ^ rhs; }), "^");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs ^ rhs; }, chaiscript::pure), "^");
   }
 
   template<typename T>
   void bitwise_or(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs | rhs; }), "|");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs | rhs; }, chaiscript::pure), "|");
   }
 
   template<typename T>
   void division(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs / rhs; }), "/");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs / rhs; }, chaiscript::pure), "/");
   }
 
   template<typename T>
   void left_shift(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs << rhs; }), "<<");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs << rhs; }, chaiscript::pure), "<<");
   }
 
   template<typename T>
   void multiplication(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs * rhs; }), "*");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs * rhs; }, chaiscript::pure), "*");
   }
 
   template<typename T>
   void remainder(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs % rhs; }), "%");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs % rhs; }, chaiscript::pure), "%");
   }
 
   template<typename T>
   void right_shift(Module &m) {
-    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs >> rhs; }), ">>");
+    m.add(chaiscript::fun([](const T &lhs, const T &rhs) { return lhs >> rhs; }, chaiscript::pure), ">>");
   }
 } // namespace chaiscript::bootstrap::operators
 
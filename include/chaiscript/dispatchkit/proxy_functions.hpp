@@ -14,6 +14,7 @@
 #include <functional>
 #include <iterator>
 #include <memory>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <type_traits>
@@ -148,6 +149,9 @@ namespace chaiscript {
 
       const std::vector<std::pair<std::string, Type_Info>> &types() const noexcept { return m_types; }
 
+      /// \returns true if any of the parameters is typed
+      bool has_types() const noexcept { return m_has_types; }
+
     private:
       void update_has_types() {
         for (const auto &type : m_types) {
@@ -197,6 +201,12 @@ namespace chaiscript {
 
       bool has_arithmetic_param() const noexcept { return m_has_arithmetic_param; }
 
+      /// \returns true if the function was declared pure when it was registered, see chaiscript::pure
+      bool is_pure() const noexcept { return m_pure; }
+
+      /// Declares the function pure: it has no side effects and its result depends only on its arguments
+      void set_pure(const bool t_pure = true) noexcept { m_pure = t_pure; }
+
       virtual std::vector<std::shared_ptr<const Proxy_Function_Base>> get_contained_functions() const {
         return std::vector<std::shared_ptr<const Proxy_Function_Base>>();
       }
@@ -244,7 +254,8 @@ namespace chaiscript {
       Proxy_Function_Base(std::vector<Type_Info> t_types, int t_arity)
           : m_types(std::move(t_types))
           , m_arity(t_arity)
-          , m_has_arithmetic_param(false) {
+          , m_has_arithmetic_param(false)
+          , m_pure(false) {
         for (size_t i = 1; i < m_types.size(); ++i) {
           if (m_types[i].is_arithmetic()) {
             m_has_arithmetic_param = true;
@@ -270,6 +281,7 @@ namespace chaiscript {
       std::vector<Type_Info> m_types;
       int m_arity;
       bool m_has_arithmetic_param;
+      bool m_pure;
     };
   } // namespace dispatch
 
@@ -280,6 +292,29 @@ namespace chaiscript {
   ///        are handled internally.
   using Const_Proxy_Function = std::shared_ptr<const dispatch::Proxy_Function_Base>;
 
+  /// \brief Tag type of chaiscript::pure
+  struct Pure_Tag {
+  };
+
+  /// \brief Declares a function registered with fun() or Module::add() pure: it has no side effects and its result depends only on its arguments
+  ///
+  /// The optimizer may then evaluate a call to the function fewer times than the script does, for instance once
+  /// before a loop instead of on every iteration, or only once at all when every argument is a constant. It assumes that a value read by a pure function only changes
+  /// when a script assigns to it or passes it to a function that is not pure, so a pure function should return
+  /// values rather than references into its arguments.
+  ///
+  /// \b Example:
+  /// \code
+  /// double lerp(double, double, double);
+  ///
+  /// chaiscript::ChaiScript chai;
+  /// chai.add(fun(&lerp, chaiscript::pure), "lerp");
+  ///
+  /// chaiscript::Module m;
+  /// m.add(fun(&lerp), "lerp", chaiscript::pure);
+  /// \endcode
+  inline constexpr Pure_Tag pure{};
+
   namespace exception {
     /// \brief  Exception thrown if a function's guard fails
     class guard_error : public std::runtime_error {
@@ -302,11 +337,13 @@ namespace chaiscript {
       Dynamic_Proxy_Function(const int t_arity,
                              std::shared_ptr<AST_Node> t_parsenode,
                              Param_Types t_param_types = Param_Types(),
-                             Proxy_Function t_guard = Proxy_Function())
+                             Proxy_Function t_guard = Proxy_Function(),
+                             std::optional<std::vector<std::string>> t_param_names = std::nullopt)
           : Proxy_Function_Base(build_param_type_list(t_param_types), t_arity)
           , m_param_types(std::move(t_param_types))
           , m_guard(std::move(t_guard))
-          , m_parsenode(std::move(t_parsenode)) {
+          , m_parsenode(std::move(t_parsenode))
+          , m_param_names(std::move(t_param_names)) {
         // assert(t_parsenode);
       }
 
@@ -328,6 +365,26 @@ namespace chaiscript {
 
       bool has_parse_tree() const noexcept { return static_cast<bool>(m_parsenode); }
 
+      bool has_typed_params() const noexcept { return m_param_types.has_types(); }
+
+      /// Set for functions whose call is nothing more than evaluating the parse tree with the named
+      /// parameters in a fresh scope (i.e. `def`), which lets call sites evaluate the body themselves
+      const std::optional<std::vector<std::string>> &get_param_names() const noexcept { return m_param_names; }
+
+      /// The arguments a call with t_params hands to the function: checked against the parameter types and the
+      /// guard, and converted where needed. Lets a caller that evaluates the parse tree itself make the same checks.
+      /// \throws exception::guard_error if a call with t_params would
+      std::vector<Boxed_Value> checked_params(const Function_Params &t_params, const Type_Conversions_State &t_conversions) const {
+        const auto [is_a_match, needs_conversions] = call_match_internal(t_params, t_conversions);
+        if (!is_a_match) {
+          throw exception::guard_error();
+        } else if (needs_conversions) {
+          return m_param_types.convert(t_params, t_conversions);
+        } else {
+          return t_params.to_vector();
+        }
+      }
+
       const AST_Node &get_parse_tree() const {
         if (m_parsenode) {
           return *m_parsenode;
@@ -389,6 +446,7 @@ namespace chaiscript {
     private:
       Proxy_Function m_guard;
       std::shared_ptr<AST_Node> m_parsenode;
+      std::optional<std::vector<std::string>> m_param_names;
     };
 
     template<typename Callable>
@@ -398,8 +456,9 @@ namespace chaiscript {
                                   int t_arity = -1,
                                   std::shared_ptr<AST_Node> t_parsenode = AST_NodePtr(),
                                   Param_Types t_param_types = Param_Types(),
-                                  Proxy_Function t_guard = Proxy_Function())
-          : Dynamic_Proxy_Function(t_arity, std::move(t_parsenode), std::move(t_param_types), std::move(t_guard))
+                                  Proxy_Function t_guard = Proxy_Function(),
+                                  std::optional<std::vector<std::string>> t_param_names = std::nullopt)
+          : Dynamic_Proxy_Function(t_arity, std::move(t_parsenode), std::move(t_param_types), std::move(t_guard), std::move(t_param_names))
           , m_f(std::move(t_f)) {
       }
 
@@ -710,6 +769,23 @@ namespace chaiscript {
             == std::make_pair(plist.end(), types.end());
       }
 
+      /// Parameter lists up to this size are evaluated or converted into a stack buffer instead of a std::vector
+      static constexpr std::size_t max_stack_params = 8;
+
+      /// Appends plist to t_newplist, converting each arithmetic param to the exact arithmetic type expected by tis
+      template<typename Container>
+      void convert_arithmetic_params(const std::vector<Type_Info> &tis, const chaiscript::Function_Params &plist, Container &t_newplist) {
+        auto ti = tis.begin() + 1;
+        for (const auto &param : plist) {
+          if (ti->is_arithmetic() && param.get_type_info().is_arithmetic() && param.get_type_info() != *ti) {
+            t_newplist.emplace_back(Boxed_Number(param).get_as(*ti).bv);
+          } else {
+            t_newplist.emplace_back(param);
+          }
+          ++ti;
+        }
+      }
+
       template<typename InItr, typename Funcs>
       Boxed_Value dispatch_with_conversions(InItr begin,
                                             const InItr &end,
@@ -746,20 +822,19 @@ namespace chaiscript {
           throw exception::dispatch_error(plist, std::vector<Const_Proxy_Function>(t_funcs.begin(), t_funcs.end()));
         }
 
-        std::vector<Boxed_Value> newplist;
-        newplist.reserve(plist.size());
-
         const std::vector<Type_Info> &tis = matching_func->second->get_param_types();
-        std::transform(tis.begin() + 1, tis.end(), plist.begin(), std::back_inserter(newplist), [](const Type_Info &ti, const Boxed_Value &param) -> Boxed_Value {
-          if (ti.is_arithmetic() && param.get_type_info().is_arithmetic() && param.get_type_info() != ti) {
-            return Boxed_Number(param).get_as(ti).bv;
-          } else {
-            return param;
-          }
-        });
 
         try {
-          return (*(matching_func->second))(chaiscript::Function_Params{newplist}, t_conversions);
+          if (plist.size() <= max_stack_params) {
+            utility::Stack_Vector<Boxed_Value, max_stack_params> newplist;
+            convert_arithmetic_params(tis, plist, newplist);
+            return (*(matching_func->second))(chaiscript::Function_Params{newplist}, t_conversions);
+          } else {
+            std::vector<Boxed_Value> newplist;
+            newplist.reserve(plist.size());
+            convert_arithmetic_params(tis, plist, newplist);
+            return (*(matching_func->second))(chaiscript::Function_Params{newplist}, t_conversions);
+          }
         } catch (const exception::bad_boxed_cast &) {
           // parameter failed to cast
         } catch (const exception::arity_error &) {
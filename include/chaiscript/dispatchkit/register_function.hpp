@@ -82,6 +82,17 @@ namespace chaiscript {
     return dispatch::detail::make_callable(std::forward<T>(t), dispatch::detail::function_signature(t));
   }
 
+  /// \brief Creates a new Proxy_Function object from a free function, member function or data member and declares it pure
+  /// \param[in] t Function / member to expose
+  ///
+  /// \sa chaiscript::pure
+  template<typename T>
+  Proxy_Function fun(T &&t, Pure_Tag) {
+    auto f = fun(std::forward<T>(t));
+    f->set_pure();
+    return f;
+  }
+
   /// \brief Creates a new Proxy_Function object from a free function, member function or data member and binds the first parameter of it
   /// \param[in] t Function / member to expose
   /// \param[in] q Value to bind to first parameter
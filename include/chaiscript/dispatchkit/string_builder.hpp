@@ -0,0 +1,60 @@
+// This file is distributed under the BSD License.
+// See "license.txt" for details.
+// Copyright 2009-2012, Jonathan Turner (jonathan@emptycrate.com)
+// Copyright 2009-2018, Jason Turner (jason@emptycrate.com)
+// http://www.chaiscript.com
+
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#ifndef CHAISCRIPT_STRING_BUILDER_HPP_
+#define CHAISCRIPT_STRING_BUILDER_HPP_
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace chaiscript::dispatch {
+  /// Text built up one piece at a time, for scripts that make large strings. Pieces are appended in place, and
+  /// the finished text is handed over with take() rather than copied.
+  class String_Builder {
+  public:
+    String_Builder() = default;
+
+    explicit String_Builder(std::string t_text)
+        : m_text(std::move(t_text)) {
+    }
+
+    String_Builder &append(const std::string_view t_piece) {
+      m_text.append(t_piece);
+      return *this;
+    }
+
+    String_Builder &append(const char t_c) {
+      m_text.push_back(t_c);
+      return *this;
+    }
+
+    std::size_t size() const noexcept { return m_text.size(); }
+
+    bool empty() const noexcept { return m_text.empty(); }
+
+    void clear() noexcept { m_text.clear(); }
+
+    void reserve(const std::size_t t_size) { m_text.reserve(t_size); }
+
+    std::size_t capacity() const noexcept { return m_text.capacity(); }
+
+    /// The text so far
+    const std::string &str() const noexcept { return m_text; }
+
+    /// The text so far, leaving this empty
+    std::string take() noexcept { return std::exchange(m_text, std::string()); }
+
+  private:
+    std::string m_text;
+  };
+} // namespace chaiscript::dispatch
+
+#endif
@@ -0,0 +1,338 @@
+// This file is distributed under the BSD License.
+// See "license.txt" for details.
+// Copyright 2009-2012, Jonathan Turner (jonathan@emptycrate.com)
+// Copyright 2009-2018, Jason Turner (jason@emptycrate.com)
+// http://www.chaiscript.com
+
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#ifndef CHAISCRIPT_ALGORITHMS_HPP_
+#define CHAISCRIPT_ALGORITHMS_HPP_
+
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "../dispatchkit/bootstrap_stl.hpp"
+#include "../dispatchkit/boxed_cast.hpp"
+#include "../dispatchkit/boxed_number.hpp"
+#include "../dispatchkit/boxed_value.hpp"
+#include "../dispatchkit/dispatchkit.hpp"
+#include "../dispatchkit/integral_range.hpp"
+#include "../dispatchkit/proxy_functions.hpp"
+#include "../dispatchkit/register_function.hpp"
+#include "chaiscript_algebraic.hpp"
+#include "chaiscript_common.hpp"
+
+namespace chaiscript {
+  /// C++ versions of the prelude's `map`, `filter`, `foldl`, `sum`, `product`, `join`, `take`, `drop`, `reduce`,
+  /// `any_of` and `all_of` for Vector and Integral_Range. They walk the container directly and call the function
+  /// they are given as it is, instead of going through `range`, `empty`, `front`, `pop_front` and `push_back` for
+  /// every element. Any other container or range still gets the prelude's version.
+  ///
+  /// Values are copied, assigned and compared for truth as the prelude's versions do it.
+  class Native_Algorithms {
+  public:
+    static void add(chaiscript::detail::Dispatch_Engine &t_engine) {
+      add<std::vector<Boxed_Value>>(t_engine);
+      add<dispatch::Integral_Range>(t_engine);
+    }
+
+  private:
+    using Vector = std::vector<Boxed_Value>;
+    using Function = dispatch::Proxy_Function_Base;
+
+    /// What one run of an algorithm needs to call functions the way a script does
+    class Calls {
+    public:
+      Calls(chaiscript::detail::Dispatch_Engine &t_engine, const char *t_algorithm)
+          : m_engine(t_engine)
+          , m_conversions(t_engine.conversions(), t_engine.conversions().conversion_saves())
+          , m_algorithm(t_algorithm) {
+      }
+
+      /// Calls the function the algorithm was given
+      template<typename... Param>
+      Boxed_Value call(const Function &t_func, Param &&...t_params) const {
+        std::array<Boxed_Value, sizeof...(Param)> params{Boxed_Value(std::forward<Param>(t_params))...};
+        try {
+          return t_func(Function_Params{params}, m_conversions);
+        } catch (const exception::arity_error &e) {
+          throw exception::eval_error(std::string(e.what()) + " with function given to '" + m_algorithm + "'");
+        } catch (const exception::guard_error &e) {
+          throw exception::eval_error(std::string(e.what()) + " with function given to '" + m_algorithm + "'");
+        } catch (const exception::bad_boxed_cast &e) {
+          // would otherwise be taken for this algorithm not matching its own parameters
+          throw exception::eval_error(std::string(e.what()) + " with function given to '" + m_algorithm + "'");
+        }
+      }
+
+      /// Calls the function a script would find by t_name
+      template<typename... Param>
+      Boxed_Value call(const char *t_name, std::atomic_uint_fast32_t &t_loc, Param &&...t_params) const {
+        std::array<Boxed_Value, sizeof...(Param)> params{Boxed_Value(std::forward<Param>(t_params))...};
+        return m_engine.call_function(t_name, t_loc, Function_Params{params}, m_conversions);
+      }
+
+      /// Appends the text of t_bv, as `to_string` gives it, to t_text
+      void append_text(std::string &t_text, const Boxed_Value &t_bv) {
+        bootstrap::standard_library::detail::append_text(m_engine, m_conversions, m_to_string_loc, t_text, t_bv);
+      }
+
+      bool condition(const Boxed_Value &t_bv) const {
+        try {
+          return boxed_cast<bool>(t_bv, &m_conversions);
+        } catch (const exception::bad_boxed_cast &) {
+          throw exception::eval_error("Condition not boolean");
+        }
+      }
+
+      /// A value of its own for t_bv, as `auto x = t_bv` gives
+      Boxed_Value copy(Boxed_Value t_bv) {
+        if (t_bv.is_return_value()) {
+          t_bv.reset_return_value();
+          return t_bv;
+        }
+
+        const auto &type = t_bv.get_type_info();
+        if (type.bare_equal_type_info(typeid(bool))) {
+          return Boxed_Value(*static_cast<const bool *>(t_bv.get_const_ptr()));
+        } else if (type.is_arithmetic()) {
+          return Boxed_Number::clone(t_bv);
+        } else if (type.bare_equal_type_info(typeid(std::string))) {
+          return Boxed_Value(*static_cast<const std::string *>(t_bv.get_const_ptr()));
+        } else {
+          return call("clone", m_clone_loc, std::move(t_bv));
+        }
+      }
+
+      /// Appends t_bv to t_vec, as `push_back` does
+      void push_back(Vector &t_vec, Boxed_Value t_bv) { t_vec.push_back(copy(std::move(t_bv))); }
+
+      /// t_lhs = t_rhs
+      void assign(Boxed_Value &t_lhs, Boxed_Value t_rhs) {
+        if (t_lhs.get_type_info().is_arithmetic() && t_rhs.get_type_info().is_arithmetic()) {
+          try {
+            Boxed_Number::do_oper(Operators::Opers::assign, t_lhs, t_rhs);
+          } catch (const std::exception &) {
+            throw exception::eval_error("Error with unsupported arithmetic assignment operation.");
+          }
+        } else {
+          if (t_lhs.is_undef()) {
+            t_rhs = copy(std::move(t_rhs));
+          }
+          call("=", m_assign_loc, t_lhs, std::move(t_rhs));
+        }
+      }
+
+    private:
+      chaiscript::detail::Dispatch_Engine &m_engine;
+      Type_Conversions_State m_conversions;
+      const char *m_algorithm;
+      std::atomic_uint_fast32_t m_clone_loc = {0};
+      std::atomic_uint_fast32_t m_assign_loc = {0};
+      std::atomic_uint_fast32_t m_to_string_loc = {0};
+    };
+
+    /// Calls t_visit with each element in turn until it returns false. Elements a call adds or removes are
+    /// not visited, and no element is visited after the container has shrunk past it.
+    template<typename Visit>
+    static void walk(const Vector &t_vec, Visit t_visit) {
+      const auto size = t_vec.size();
+      for (std::size_t i = 0; i < size && i < t_vec.size(); ++i) {
+        if (!t_visit(Boxed_Value(t_vec[i]))) {
+          return;
+        }
+      }
+    }
+
+    template<typename Visit>
+    static void walk(dispatch::Integral_Range t_range, Visit t_visit) {
+      for (; !t_range.empty(); t_range.pop_front()) {
+        if (!t_visit(t_range.front())) {
+          return;
+        }
+      }
+    }
+
+    /// The number of times `while (i > 0) { ...; --i; }` goes round starting from t_num
+    static unsigned long long count_down(const Boxed_Number &t_num) {
+      if (t_num.get_as<long double>() <= 0) {
+        return 0;
+      } else if (Boxed_Number::is_floating_point(t_num.bv)) {
+        return static_cast<unsigned long long>(std::ceil(t_num.get_as<long double>()));
+      } else {
+        return t_num.get_as<unsigned long long>();
+      }
+    }
+
+    static bool is_number(const Boxed_Value &t_bv) noexcept {
+      return t_bv.get_type_info().is_arithmetic() && !t_bv.get_type_info().bare_equal_type_info(typeid(bool));
+    }
+
+    template<typename Container>
+    static void add(chaiscript::detail::Dispatch_Engine &t_engine) {
+      auto &engine = t_engine;
+
+      engine.add(fun([&engine](const Container &t_container, const Function &t_func) {
+                   Calls calls(engine, "map");
+                   Vector retval;
+                   walk(t_container, [&](Boxed_Value t_bv) {
+                     calls.push_back(retval, calls.call(t_func, std::move(t_bv)));
+                     return true;
+                   });
+                   return retval;
+                 }),
+                 "map");
+
+      engine.add(fun([&engine](const Container &t_container, const Function &t_func) {
+                   Calls calls(engine, "filter");
+                   Vector retval;
+                   walk(t_container, [&](Boxed_Value t_bv) {
+                     if (calls.condition(calls.call(t_func, t_bv))) {
+                       calls.push_back(retval, std::move(t_bv));
+                     }
+                     return true;
+                   });
+                   return retval;
+                 }),
+                 "filter");
+
+      engine.add(fun([&engine](const Container &t_container, const Function &t_func, const Boxed_Value &t_initial) {
+                   Calls calls(engine, "foldl");
+                   auto retval = calls.copy(t_initial);
+                   walk(t_container, [&](Boxed_Value t_bv) {
+                     calls.assign(retval, calls.call(t_func, std::move(t_bv), retval));
+                     return true;
+                   });
+                   return retval;
+                 }),
+                 "foldl");
+
+      engine.add(fun([&engine](const Container &t_container) { return fold_numbers(engine, t_container, "+", Operators::Opers::sum, 0.0); }),
+                 "sum");
+
+      engine.add(fun([&engine](const Container &t_container) {
+                   return fold_numbers(engine, t_container, "*", Operators::Opers::product, 1.0);
+                 }),
+                 "product");
+
+      engine.add(fun([&engine](const Container &t_container, const std::string &t_delim) {
+                   Calls calls(engine, "join");
+                   std::string retval;
+                   bool first = true;
+                   walk(t_container, [&](const Boxed_Value &t_bv) {
+                     if (!first) {
+                       retval += t_delim;
+                     }
+                     first = false;
+                     calls.append_text(retval, t_bv);
+                     return true;
+                   });
+                   return retval;
+                 }),
+                 "join");
+
+      engine.add(fun([&engine](const Container &t_container, const Boxed_Number &t_num) {
+                   Calls calls(engine, "take");
+                   Vector retval;
+                   auto remaining = count_down(t_num);
+                   if (remaining > 0) {
+                     walk(t_container, [&](Boxed_Value t_bv) {
+                       calls.push_back(retval, std::move(t_bv));
+                       return --remaining > 0;
+                     });
+                   }
+                   return retval;
+                 }),
+                 "take");
+
+      engine.add(fun([&engine](const Container &t_container, const Boxed_Number &t_num) {
+                   Calls calls(engine, "drop");
+                   Vector retval;
+                   auto skip = count_down(t_num);
+                   walk(t_container, [&](Boxed_Value t_bv) {
+                     if (skip > 0) {
+                       --skip;
+                     } else {
+                       calls.push_back(retval, std::move(t_bv));
+                     }
+                     return true;
+                   });
+                   return retval;
+                 }),
+                 "drop");
+
+      engine.add(fun([&engine](const Container &t_container, const Function &t_func) {
+                   if (t_container.size() < 2) {
+                     // as the prelude's guard has it
+                     throw exception::guard_error();
+                   }
+
+                   Calls calls(engine, "reduce");
+                   Boxed_Value retval;
+                   bool first = true;
+                   walk(t_container, [&](Boxed_Value t_bv) {
+                     if (first) {
+                       retval = calls.copy(std::move(t_bv));
+                       first = false;
+                     } else {
+                       calls.assign(retval, calls.call(t_func, retval, std::move(t_bv)));
+                     }
+                     return true;
+                   });
+                   return retval;
+                 }),
+                 "reduce");
+
+      engine.add(fun([&engine](const Container &t_container, const Function &t_func) {
+                   Calls calls(engine, "any_of");
+                   bool retval = false;
+                   walk(t_container, [&](Boxed_Value t_bv) {
+                     retval = calls.condition(calls.call(t_func, std::move(t_bv)));
+                     return !retval;
+                   });
+                   return retval;
+                 }),
+                 "any_of");
+
+      engine.add(fun([&engine](const Container &t_container, const Function &t_func) {
+                   Calls calls(engine, "all_of");
+                   bool retval = true;
+                   walk(t_container, [&](Boxed_Value t_bv) {
+                     retval = calls.condition(calls.call(t_func, std::move(t_bv)));
+                     return retval;
+                   });
+                   return retval;
+                 }),
+                 "all_of");
+    }
+
+    /// `foldl(t_container, t_oper, t_initial)`, adding up numbers without dispatching the operator
+    template<typename Container>
+    static Boxed_Value fold_numbers(chaiscript::detail::Dispatch_Engine &t_engine,
+                                    const Container &t_container,
+                                    const char *t_oper_name,
+                                    const Operators::Opers t_oper,
+                                    const double t_initial) {
+      Calls calls(t_engine, t_oper == Operators::Opers::sum ? "sum" : "product");
+      std::atomic_uint_fast32_t oper_loc = {0};
+      Boxed_Value retval(t_initial);
+      walk(t_container, [&](Boxed_Value t_bv) {
+        if (is_number(t_bv)) {
+          calls.assign(retval, Boxed_Number::do_oper(t_oper, t_bv, retval));
+        } else {
+          calls.assign(retval, calls.call(t_oper_name, oper_loc, std::move(t_bv), retval));
+        }
+        return true;
+      });
+      return retval;
+    }
+  };
+} // namespace chaiscript
+
+#endif
@@ -604,7 +604,7 @@ namespace chaiscript {
   namespace parser {
     class ChaiScript_Parser_Base {
     public:
-      virtual AST_NodePtr parse(const std::string &t_input, const std::string &t_fname) = 0;
+      virtual AST_NodePtr parse(std::string_view t_input, const std::string &t_fname) = 0;
       virtual void debug_print(const AST_Node &t, std::string prepend = "") const = 0;
       virtual void *get_tracer_ptr() = 0;
       virtual ~ChaiScript_Parser_Base() = default;
@@ -657,6 +657,14 @@ namespace chaiscript {
         const chaiscript::detail::Dispatch_State &m_ds;
       };
 
+      /// True for a number, boolean or string held by value: it owns its data, so it can never dangle
+      /// and a node may keep it and hand out copies of it
+      inline bool is_reusable_value(const Boxed_Value &t_bv) noexcept {
+        const auto &type = t_bv.get_type_info();
+        return !t_bv.is_ref()
+            && (type.is_arithmetic() || type.bare_equal_type_info(typeid(bool)) || type.bare_equal_type_info(typeid(std::string)));
+      }
+
       /// Creates a new function call and pops it on destruction
       struct Function_Push_Pop {
         Function_Push_Pop(Function_Push_Pop &&) = default;
@@ -671,7 +679,15 @@ namespace chaiscript {
 
         ~Function_Push_Pop() { m_ds->pop_function_call(m_ds.stack_holder(), m_ds.conversion_saves()); }
 
-        void save_params(const Function_Params &t_params) { m_ds->save_function_params(t_params); }
+        void save_params(const Function_Params &t_params) { m_ds->save_function_params(m_ds.stack_holder(), t_params); }
+
+        /// Saves the params only if t_result might refer into one of them. Plain values that
+        /// own their data (numbers, bools, strings, void) can never dangle, so nothing is kept.
+        void save_params(const Function_Params &t_params, const Boxed_Value &t_result) {
+          if (!t_result.is_undef() && !is_reusable_value(t_result)) {
+            save_params(t_params);
+          }
+        }
 
       private:
         const chaiscript::detail::Dispatch_State &m_ds;
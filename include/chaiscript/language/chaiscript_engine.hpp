@@ -10,16 +10,18 @@
 #ifndef CHAISCRIPT_ENGINE_HPP_
 #define CHAISCRIPT_ENGINE_HPP_
 
+#include <array>
 #include <cassert>
 #include <cstring>
 #include <exception>
-#include <fstream>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <set>
+#include <span>
 #include <stdexcept>
+#include <tuple>
 #include <vector>
 
 #include "../chaiscript_defines.hpp"
@@ -30,6 +32,7 @@
 #include "../dispatchkit/proxy_functions.hpp"
 #include "../dispatchkit/register_function.hpp"
 #include "../dispatchkit/type_conversions.hpp"
+#include "../utility/mapped_file.hpp"
 #include "chaiscript_common.hpp"
 
 #if defined(__linux__) || defined(__unix__) || defined(__APPLE__) || defined(__HAIKU__)
@@ -58,7 +61,15 @@ namespace chaiscript {
 
   namespace detail {
     using Loadable_Module_Ptr = std::shared_ptr<Loadable_Module>;
-  }
+
+    template<typename T>
+    struct Is_Tuple : std::false_type {
+    };
+
+    template<typename... T>
+    struct Is_Tuple<std::tuple<T...>> : std::true_type {
+    };
+  } // namespace detail
 
   /// \brief The main object that the ChaiScript user will use.
   class ChaiScript_Basic {
@@ -79,21 +90,35 @@ namespace chaiscript {
     std::map<std::string, std::function<Namespace &()>> m_namespace_generators;
 
     /// Evaluates the given string in by parsing it and running the results through the evaluator
-    Boxed_Value do_eval(const std::string &t_input, const std::string &t_filename = "__EVAL__", bool /* t_internal*/ = false) {
+    Boxed_Value do_eval(std::string_view t_input, const std::string &t_filename = "__EVAL__", bool /* t_internal*/ = false) {
+      return do_eval(m_parser->parse(t_input, t_filename));
+    }
+
+    /// Runs an already parsed script through the evaluator
+    Boxed_Value do_eval(const AST_NodePtr &t_ast) {
       try {
-        const auto p = m_parser->parse(t_input, t_filename);
-        return p->eval(chaiscript::detail::Dispatch_State(m_engine));
+        return t_ast->eval(chaiscript::detail::Dispatch_State(m_engine));
       } catch (chaiscript::eval::detail::Return_Value &rv) {
         return rv.retval;
       }
     }
 
+    /// Evaluates the given file, parsing it straight from the mapped file. The file is only mapped while it is
+    /// parsed, since the AST keeps its own copies of the text it needs.
+    Boxed_Value do_eval_file(const std::string &t_filename) {
+      const auto ast = [&]() {
+        const auto file = map_file(t_filename);
+        return m_parser->parse(skip_bom(file.text()), t_filename);
+      }();
+      return do_eval(ast);
+    }
+
     /// Evaluates the given file and looks in the 'use' paths
     Boxed_Value internal_eval_file(const std::string &t_filename) {
       for (const auto &path : m_use_paths) {
         try {
           const auto appendedpath = path + t_filename;
-          return do_eval(load_file(appendedpath), appendedpath, true);
+          return do_eval_file(appendedpath);
         } catch (const exception::file_not_found_error &) {
           // failed to load, try the next path
         } catch (const exception::eval_error &t_ee) {
@@ -130,6 +155,7 @@ namespace chaiscript {
       m_engine.add(fun([this](const std::string &t_f) { return m_engine.function_exists(t_f); }), "function_exists");
       m_engine.add(fun([this]() { return m_engine.get_function_objects(); }), "get_functions");
       m_engine.add(fun([this]() { return m_engine.get_scripting_objects(); }), "get_objects");
+      m_engine.add(fun([this]() { return m_engine.avoided_clones(); }), "avoided_clones");
 
       m_engine.add(dispatch::make_dynamic_proxy_function([this](const Function_Params &t_params) { return m_engine.call_exists(t_params); }),
                    "call_exists");
@@ -182,49 +208,25 @@ namespace chaiscript {
     }
 
     /// Skip BOM at the beginning of file
-    static bool skip_bom(std::ifstream &infile) {
-      size_t bytes_needed = 3;
-      char buffer[3];
-
-      memset(buffer, '\0', bytes_needed);
+    static std::string_view skip_bom(std::string_view t_text) noexcept {
+      constexpr std::string_view bom("\xef\xbb\xbf");
 
-      infile.read(buffer, static_cast<std::streamsize>(bytes_needed));
-
-      if ((buffer[0] == '\xef') && (buffer[1] == '\xbb') && (buffer[2] == '\xbf')) {
-        infile.seekg(3);
-        return true;
+      if (t_text.substr(0, bom.size()) == bom) {
+        t_text.remove_prefix(bom.size());
       }
 
-      infile.seekg(0);
-
-      return false;
+      return t_text;
     }
 
     /// Helper function for loading a file
-    static std::string load_file(const std::string &t_filename) {
-      std::ifstream infile(t_filename.c_str(), std::ios::in | std::ios::ate | std::ios::binary);
+    static utility::Mapped_File map_file(const std::string &t_filename) {
+      utility::Mapped_File file(t_filename);
 
-      if (!infile.is_open()) {
+      if (!file.is_open()) {
         throw chaiscript::exception::file_not_found_error(t_filename);
       }
 
-      auto size = infile.tellg();
-      infile.seekg(0, std::ios::beg);
-
-      assert(size >= 0);
-
-      if (skip_bom(infile)) {
-        size -= 3; // decrement the BOM size from file size, otherwise we'll get parsing errors
-        assert(size >= 0); // and check if there's more text
-      }
-
-      if (size == std::streampos(0)) {
-        return std::string();
-      } else {
-        std::vector<char> v(static_cast<size_t>(size));
-        infile.read(&v[0], static_cast<std::streamsize>(size));
-        return std::string(v.begin(), v.end());
-      }
+      return file;
     }
 
     std::vector<std::string> ensure_minimum_path_vec(std::vector<std::string> paths) {
@@ -516,6 +518,13 @@ namespace chaiscript {
       return *this;
     }
 
+    /// \brief Lets ranged for loops walk a C++ container type natively
+    /// \sa chaiscript::native_iteration
+    ChaiScript_Basic &add(const Native_Iteration &t_iteration) {
+      m_engine.add(t_iteration);
+      return *this;
+    }
+
     /// \brief Adds all elements of a module to ChaiScript runtime
     /// \param[in] t_p The module to add.
     /// \sa chaiscript::Module
@@ -629,6 +638,48 @@ namespace chaiscript {
       return (m_engine.boxed_cast<Type>(bv));
     }
 
+    /// \brief Calls a script function once for each element of t_inputs, storing each result
+    ///        in the matching element of t_outputs.
+    ///
+    /// The function object is resolved and the type conversion state is set up a single time for the
+    /// whole batch, instead of once per call as happens when going through a std::function.
+    /// If Param is a std::tuple its elements are passed as separate arguments.
+    ///
+    /// \code
+    /// chai.eval("def score(x) { x * 2.0 }");
+    /// std::vector<double> in{1.0, 2.0, 3.0}, out(3);
+    /// chai.call_batch(chai.eval("score"), std::span<const double>(in), std::span<double>(out));
+    /// \endcode
+    ///
+    /// \throw std::range_error In the case that t_outputs is smaller than t_inputs
+    /// \throw chaiscript::exception::bad_boxed_cast In the case that t_func is not a function or a result cannot be converted
+    template<typename Ret, typename Param>
+    void call_batch(const Boxed_Value &t_func, std::span<const Param> t_inputs, std::span<Ret> t_outputs) {
+      if (t_outputs.size() < t_inputs.size()) {
+        throw std::range_error("Output range is smaller than input range");
+      }
+
+      const auto func = m_engine.boxed_cast<Const_Proxy_Function>(t_func);
+      const Type_Conversions_State state(m_engine.conversions(), m_engine.conversions().conversion_saves());
+
+      for (size_t i = 0; i < t_inputs.size(); ++i) {
+        const auto result = [&]() {
+          if constexpr (detail::Is_Tuple<Param>::value) {
+            return std::apply(
+                [&](const auto &...args) {
+                  std::array<Boxed_Value, sizeof...(args)> params{Boxed_Value(args)...};
+                  return (*func)(Function_Params{params}, state);
+                },
+                t_inputs[i]);
+          } else {
+            return (*func)(Function_Params{Boxed_Value(t_inputs[i])}, state);
+          }
+        }();
+
+        t_outputs[i] = chaiscript::boxed_cast<Ret>(result, &state);
+      }
+    }
+
     /// \brief Evaluates a string.
     ///
     /// \param[in] t_input Script to execute
@@ -657,7 +708,14 @@ namespace chaiscript {
     /// \return result of the script execution
     /// \throw chaiscript::exception::eval_error In the case that evaluation fails.
     Boxed_Value eval_file(const std::string &t_filename, const Exception_Handler &t_handler = Exception_Handler()) {
-      return eval(load_file(t_filename), t_handler, t_filename);
+      try {
+        return do_eval_file(t_filename);
+      } catch (Boxed_Value &bv) {
+        if (t_handler) {
+          t_handler->handle(bv, m_engine);
+        }
+        throw;
+      }
     }
 
     /// \brief Loads the file specified by filename, evaluates it, and returns the type safe result.
@@ -10,14 +10,17 @@
 #ifndef CHAISCRIPT_EVAL_HPP_
 #define CHAISCRIPT_EVAL_HPP_
 
+#include <algorithm>
 #include <exception>
 #include <functional>
 #include <limits>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <stdexcept>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "../chaiscript_defines.hpp"
@@ -26,10 +29,13 @@
 #include "../dispatchkit/boxed_value.hpp"
 #include "../dispatchkit/dispatchkit.hpp"
 #include "../dispatchkit/dynamic_object_detail.hpp"
+#include "../dispatchkit/integral_range.hpp"
 #include "../dispatchkit/proxy_functions.hpp"
 #include "../dispatchkit/proxy_functions_detail.hpp"
 #include "../dispatchkit/register_function.hpp"
 #include "../dispatchkit/type_info.hpp"
+#include "../utility/interned_string.hpp"
+#include "../utility/stack_vector.hpp"
 #include "chaiscript_algebraic.hpp"
 #include "chaiscript_common.hpp"
 
@@ -47,13 +53,23 @@ namespace chaiscript {
     using AST_Node_Impl_Ptr = typename std::unique_ptr<AST_Node_Impl<T>>;
 
     namespace detail {
+      /// The values a lambda captured when it was created, resolved once into a flat array in the order of
+      /// its capture list. A call binds the array to its stack as it is, and the Id nodes of the body find
+      /// each capture by its index, see Dispatch_Engine::get_object
+      struct Captures {
+        std::shared_ptr<const chaiscript::detail::Stack_Holder::Captures> values;
+        /// set when the names of the captures and of the parameters are all different. Otherwise the
+        /// captures are added to the call's scope by name, which reports the conflict
+        bool distinct_names = false;
+      };
+
       /// Helper function that will set up the scope around a function call, including handling the named function parameters
       template<typename T>
       Boxed_Value eval_function(chaiscript::detail::Dispatch_Engine &t_ss,
                                 const AST_Node_Impl<T> &t_node,
                                 const std::vector<std::string> &t_param_names,
                                 const Function_Params &t_vals,
-                                const std::map<std::string, Boxed_Value> *t_locals = nullptr,
+                                const Captures *t_captures = nullptr,
                                 bool has_this_capture = false) {
         chaiscript::detail::Dispatch_State state(t_ss);
 
@@ -68,12 +84,15 @@ namespace chaiscript {
         }();
 
         chaiscript::eval::detail::Stack_Push_Pop tpp(state);
+
         if (thisobj && !has_this_capture) {
           state.add_object("this", *thisobj);
         }
 
-        if (t_locals) {
-          for (const auto &[name, value] : *t_locals) {
+        if (t_captures && t_captures->distinct_names) {
+          chaiscript::detail::Dispatch_Engine::bind_captures(t_captures->values, state.stack_holder());
+        } else if (t_captures) {
+          for (const auto &[name, value] : *t_captures->values) {
             state.add_object(name, value);
           }
         }
@@ -91,23 +110,73 @@ namespace chaiscript {
         }
       }
 
+      /// The name of the indexing operator, which array and member lookups call by themselves
+      inline const utility::Interned_String &index_operator_name() {
+        static const utility::Interned_String name("[]");
+        return name;
+      }
+
+      /// The value to store for an assignment or declaration: a temporary is taken as is, anything still
+      /// referred to elsewhere is cloned. A value nothing else refers to any more, such as a local a
+      /// function returned, is a dead temporary too and is taken over instead of cloned
       inline Boxed_Value clone_if_necessary(Boxed_Value incoming, std::atomic_uint_fast32_t &t_loc, const chaiscript::detail::Dispatch_State &t_ss) {
         if (!incoming.is_return_value()) {
-          if (incoming.get_type_info().is_arithmetic()) {
+          if (incoming.is_unshared()) {
+            t_ss->count_avoided_clone();
+            return incoming;
+          } else if (incoming.get_type_info().is_arithmetic()) {
             return Boxed_Number::clone(incoming);
           } else if (incoming.get_type_info().bare_equal_type_info(typeid(bool))) {
             return Boxed_Value(*static_cast<const bool *>(incoming.get_const_ptr()));
           } else if (incoming.get_type_info().bare_equal_type_info(typeid(std::string))) {
             return Boxed_Value(*static_cast<const std::string *>(incoming.get_const_ptr()));
           } else {
+            static const utility::Interned_String clone_name("clone");
             std::array<Boxed_Value, 1> params{std::move(incoming)};
-            return t_ss->call_function("clone", t_loc, Function_Params{params}, t_ss.conversions());
+            return t_ss->call_function(clone_name, t_loc, Function_Params{params}, t_ss.conversions());
           }
         } else {
           incoming.reset_return_value();
           return incoming;
         }
       }
+
+      /// A copy of a reusable value, so that whoever receives it cannot change the one kept
+      inline Boxed_Value copy_reusable_value(const Boxed_Value &t_bv) {
+        if (t_bv.get_type_info().is_arithmetic()) {
+          return Boxed_Number::clone(t_bv);
+        } else if (t_bv.get_type_info().bare_equal_type_info(typeid(bool))) {
+          return Boxed_Value(*static_cast<const bool *>(t_bv.get_const_ptr()), t_bv.is_return_value());
+        } else {
+          return Boxed_Value(*static_cast<const std::string *>(t_bv.get_const_ptr()), t_bv.is_return_value());
+        }
+      }
+
+      /// What a function body evaluates to when it ends in a call of its own function, see Tail_Fun_Call_AST_Node:
+      /// the arguments to evaluate the body with once more
+      struct Tail_Call {
+        std::vector<Boxed_Value> params;
+      };
+
+      /// Evaluates a function body with t_eval_body, then again with the arguments of each tail call it ends in
+      template<typename Eval_Body>
+      Boxed_Value eval_tail_calls(const Function_Params &t_vals, const Eval_Body &t_eval_body) {
+        auto retval = t_eval_body(t_vals);
+        while (retval.get_type_info().bare_equal_type_info(typeid(Tail_Call))) {
+          const auto params = std::move(static_cast<Tail_Call *>(retval.get_ptr())->params);
+          retval = t_eval_body(Function_Params{params});
+        }
+        return retval;
+      }
+
+      /// Evaluates the body of a `def`, running the tail calls it ends in as a loop on the current stack frame
+      template<typename T>
+      Boxed_Value eval_def(chaiscript::detail::Dispatch_Engine &t_ss,
+                           const AST_Node_Impl<T> &t_body,
+                           const std::vector<std::string> &t_param_names,
+                           const Function_Params &t_vals) {
+        return eval_tail_calls(t_vals, [&](const Function_Params &t_params) { return eval_function(t_ss, t_body, t_param_names, t_params); });
+      }
     } // namespace detail
 
     template<typename T>
@@ -174,15 +243,16 @@ namespace chaiscript {
       Fold_Right_Binary_Operator_AST_Node(const std::string &t_oper, Parse_Location t_loc, std::vector<AST_Node_Impl_Ptr<T>> t_children, Boxed_Value t_rhs)
           : AST_Node_Impl<T>(t_oper, AST_Node_Type::Binary, std::move(t_loc), std::move(t_children))
           , m_oper(Operators::to_operator(t_oper))
+          , m_name(t_oper)
           , m_rhs(std::move(t_rhs)) {
       }
 
       Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
-        return do_oper(t_ss, this->text, this->children[0]->eval(t_ss));
+        return do_oper(t_ss, m_name, this->children[0]->eval(t_ss));
       }
 
     protected:
-      Boxed_Value do_oper(const chaiscript::detail::Dispatch_State &t_ss, const std::string &t_oper_string, const Boxed_Value &t_lhs) const {
+      Boxed_Value do_oper(const chaiscript::detail::Dispatch_State &t_ss, const utility::Interned_String &t_oper_string, const Boxed_Value &t_lhs) const {
         try {
           if (t_lhs.get_type_info().is_arithmetic()) {
             // If it's an arithmetic operation we want to short circuit dispatch
@@ -191,21 +261,23 @@ namespace chaiscript {
             } catch (const chaiscript::exception::arithmetic_error &) {
               throw;
             } catch (...) {
-              throw exception::eval_error("Error with numeric operator calling: " + t_oper_string);
+              throw exception::eval_error("Error with numeric operator calling: " + t_oper_string.str());
             }
           } else {
             chaiscript::eval::detail::Function_Push_Pop fpp(t_ss);
             std::array<Boxed_Value, 2> params{t_lhs, m_rhs};
-            fpp.save_params(Function_Params{params});
-            return t_ss->call_function(t_oper_string, m_loc, Function_Params{params}, t_ss.conversions());
+            auto retval = t_ss->call_function(t_oper_string, m_loc, Function_Params{params}, t_ss.conversions());
+            fpp.save_params(Function_Params{params}, retval);
+            return retval;
           }
         } catch (const exception::dispatch_error &e) {
-          throw exception::eval_error("Can not find appropriate '" + t_oper_string + "' operator.", e.parameters, e.functions, false, *t_ss);
+          throw exception::eval_error("Can not find appropriate '" + t_oper_string.str() + "' operator.", e.parameters, e.functions, false, *t_ss);
         }
       }
 
     private:
       Operators::Opers m_oper;
+      utility::Interned_String m_name;
       Boxed_Value m_rhs;
       mutable std::atomic_uint_fast32_t m_loc = {0};
     };
@@ -214,19 +286,25 @@ namespace chaiscript {
     struct Binary_Operator_AST_Node : AST_Node_Impl<T> {
       Binary_Operator_AST_Node(const std::string &t_oper, Parse_Location t_loc, std::vector<AST_Node_Impl_Ptr<T>> t_children)
           : AST_Node_Impl<T>(t_oper, AST_Node_Type::Binary, std::move(t_loc), std::move(t_children))
-          , m_oper(Operators::to_operator(t_oper)) {
+          , m_oper(Operators::to_operator(t_oper))
+          , m_name(t_oper) {
       }
 
       Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
         auto lhs = this->children[0]->eval(t_ss);
         auto rhs = this->children[1]->eval(t_ss);
-        return do_oper(t_ss, m_oper, this->text, lhs, rhs);
+        return do_oper(t_ss, m_oper, m_name, lhs, rhs);
+      }
+
+      /// This operator applied to values already evaluated
+      Boxed_Value apply(const chaiscript::detail::Dispatch_State &t_ss, const Boxed_Value &t_lhs, const Boxed_Value &t_rhs) const {
+        return do_oper(t_ss, m_oper, m_name, t_lhs, t_rhs);
       }
 
     protected:
       Boxed_Value do_oper(const chaiscript::detail::Dispatch_State &t_ss,
                           Operators::Opers t_oper,
-                          const std::string &t_oper_string,
+                          const utility::Interned_String &t_oper_string,
                           const Boxed_Value &t_lhs,
                           const Boxed_Value &t_rhs) const {
         try {
@@ -237,21 +315,23 @@ namespace chaiscript {
             } catch (const chaiscript::exception::arithmetic_error &) {
               throw;
             } catch (...) {
-              throw exception::eval_error("Error with numeric operator calling: " + t_oper_string);
+              throw exception::eval_error("Error with numeric operator calling: " + t_oper_string.str());
             }
           } else {
             chaiscript::eval::detail::Function_Push_Pop fpp(t_ss);
             std::array<Boxed_Value, 2> params{t_lhs, t_rhs};
-            fpp.save_params(Function_Params(params));
-            return t_ss->call_function(t_oper_string, m_loc, Function_Params(params), t_ss.conversions());
+            auto retval = t_ss->call_function(t_oper_string, m_loc, Function_Params(params), t_ss.conversions());
+            fpp.save_params(Function_Params(params), retval);
+            return retval;
           }
         } catch (const exception::dispatch_error &e) {
-          throw exception::eval_error("Can not find appropriate '" + t_oper_string + "' operator.", e.parameters, e.functions, false, *t_ss);
+          throw exception::eval_error("Can not find appropriate '" + t_oper_string.str() + "' operator.", e.parameters, e.functions, false, *t_ss);
         }
       }
 
     private:
       Operators::Opers m_oper;
+      utility::Interned_String m_name;
       mutable std::atomic_uint_fast32_t m_loc = {0};
     };
 
@@ -280,13 +360,14 @@ namespace chaiscript {
 
       Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
         try {
-          return t_ss.get_object(this->text, m_loc);
+          return t_ss.get_object(this->text, m_name, m_loc);
         } catch (std::exception &) {
           throw exception::eval_error("Can not find object: " + this->text);
         }
       }
 
     private:
+      utility::Lazy_Interned_String m_name;
       mutable std::atomic_uint_fast32_t m_loc = {0};
     };
 
@@ -301,21 +382,42 @@ namespace chaiscript {
       Boxed_Value do_eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const {
         chaiscript::eval::detail::Function_Push_Pop fpp(t_ss);
 
-        std::vector<Boxed_Value> params;
-
-        params.reserve(this->children[1]->children.size());
-        for (const auto &child : this->children[1]->children) {
-          params.push_back(child->eval(t_ss));
-        }
+        const auto &args = this->children[1]->children;
 
-        if (Save_Params) {
-          fpp.save_params(Function_Params{params});
+        if (args.size() <= dispatch::detail::max_stack_params) {
+          utility::Stack_Vector<Boxed_Value, dispatch::detail::max_stack_params> params;
+          for (const auto &child : args) {
+            params.emplace_back(child->eval(t_ss));
+          }
+          return do_call<Save_Params>(t_ss, fpp, Function_Params{params});
+        } else {
+          std::vector<Boxed_Value> params;
+          params.reserve(args.size());
+          for (const auto &child : args) {
+            params.push_back(child->eval(t_ss));
+          }
+          return do_call<Save_Params>(t_ss, fpp, Function_Params{params});
         }
+      }
 
-        Boxed_Value fn(this->children[0]->eval(t_ss));
+      template<bool Save_Params>
+      Boxed_Value do_call(const chaiscript::detail::Dispatch_State &t_ss,
+                          chaiscript::eval::detail::Function_Push_Pop &t_fpp,
+                          const Function_Params &t_params) const {
+        return do_call<Save_Params>(t_ss, t_fpp, t_params, Boxed_Value(this->children[0]->eval(t_ss)));
+      }
 
+      template<bool Save_Params>
+      Boxed_Value do_call(const chaiscript::detail::Dispatch_State &t_ss,
+                          chaiscript::eval::detail::Function_Push_Pop &t_fpp,
+                          const Function_Params &t_params,
+                          const Boxed_Value &fn) const {
         try {
-          return (*t_ss->boxed_cast<const dispatch::Proxy_Function_Base *>(fn))(Function_Params{params}, t_ss.conversions());
+          auto retval = (*t_ss->boxed_cast<const dispatch::Proxy_Function_Base *>(fn))(t_params, t_ss.conversions());
+          if (Save_Params) {
+            t_fpp.save_params(t_params, retval);
+          }
+          return retval;
         } catch (const exception::dispatch_error &e) {
           throw exception::eval_error(std::string(e.what()) + " with function '" + this->children[0]->text + "'",
                                       e.parameters,
@@ -327,7 +429,11 @@ namespace chaiscript {
             using ConstFunctionTypeRef = const Const_Proxy_Function &;
             Const_Proxy_Function f = t_ss->boxed_cast<ConstFunctionTypeRef>(fn);
             // handle the case where there is only 1 function to try to call and dispatch fails on it
-            throw exception::eval_error("Error calling function '" + this->children[0]->text + "'", params, make_vector(f), false, *t_ss);
+            throw exception::eval_error("Error calling function '" + this->children[0]->text + "'",
+                                        t_params.to_vector(),
+                                        make_vector(f),
+                                        false,
+                                        *t_ss);
           } catch (const exception::bad_boxed_cast &) {
             throw exception::eval_error("'" + this->children[0]->pretty_print() + "' does not evaluate to a function.");
           }
@@ -336,6 +442,9 @@ namespace chaiscript {
         } catch (const exception::guard_error &e) {
           throw exception::eval_error(std::string(e.what()) + " with function '" + this->children[0]->text + "'");
         } catch (detail::Return_Value &rv) {
+          if (Save_Params) {
+            t_fpp.save_params(t_params, rv.retval);
+          }
           return rv.retval;
         }
       }
@@ -354,6 +463,336 @@ namespace chaiscript {
       }
     };
 
+    /// A call to a named function, placed by optimizer::Inline. When the name resolves to a single small,
+    /// non-recursive, guard-free `def` with untyped parameters, the body is evaluated right here instead of
+    /// going through dispatch. The resolved function object is compared on every call, so redefining,
+    /// overloading or shadowing the function transparently falls back to the regular call.
+    template<typename T, bool Save_Params>
+    struct Inline_Fun_Call_AST_Node final : Fun_Call_AST_Node<T> {
+      Inline_Fun_Call_AST_Node(std::string t_ast_node_text, Parse_Location t_loc, std::vector<AST_Node_Impl_Ptr<T>> t_children)
+          : Fun_Call_AST_Node<T>(std::move(t_ast_node_text), std::move(t_loc), std::move(t_children)) {
+        assert(this->children.size() == 2 && this->children[1]->children.size() <= dispatch::detail::max_stack_params);
+      }
+
+      /// Functions whose body has more nodes than this are called normally
+      static constexpr std::size_t max_inline_nodes = 32;
+
+      Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
+        chaiscript::eval::detail::Function_Push_Pop fpp(t_ss);
+
+        utility::Stack_Vector<Boxed_Value, dispatch::detail::max_stack_params> params;
+        for (const auto &child : this->children[1]->children) {
+          params.emplace_back(child->eval(t_ss));
+        }
+
+        Boxed_Value fn(this->children[0]->eval(t_ss));
+
+        auto &cache = *m_cache;
+        if (cache.identity != fn.get_const_ptr() || (cache.body && cache.function.expired())) {
+          cache = resolve(fn, params.size());
+        }
+
+        // copied out, because the body may re-enter this node and replace the cached entry;
+        // fn keeps the function, and with it the body, alive for the duration of the call
+        const auto *body = cache.body;
+        const auto *param_names = cache.param_names;
+        if (!body) {
+          return this->template do_call<Save_Params>(t_ss, fpp, Function_Params{params}, fn);
+        }
+
+        // an inlined `def` may still end in tail calls of itself, made under its own name rather than this node's
+        const bool on_callers_stack = cache.on_callers_stack;
+        auto retval = detail::eval_tail_calls(Function_Params{params}, [&](const Function_Params &t_params) {
+          return on_callers_stack ? eval_on_callers_stack(*body, *param_names, t_params, t_ss)
+                                  : detail::eval_function(*t_ss, *body, *param_names, t_params);
+        });
+        if (Save_Params) {
+          fpp.save_params(Function_Params{params}, retval);
+        }
+        return retval;
+      }
+
+    private:
+      struct Inline_Cache {
+        /// address of the function object last called through this node. The cache does not own the
+        /// function, it may outlive the engine, so an inlined function is also tracked by a weak
+        /// reference which tells a live function from a new one allocated at the same address
+        const void *identity = nullptr;
+        std::weak_ptr<const dispatch::Proxy_Function_Base> function;
+        const AST_Node_Impl<T> *body = nullptr;
+        const std::vector<std::string> *param_names = nullptr;
+        bool on_callers_stack = false;
+      };
+
+      Inline_Cache resolve(const Boxed_Value &t_fn, const std::size_t t_num_params) const {
+        Inline_Cache cache;
+        cache.identity = t_fn.get_const_ptr();
+
+        const dispatch::Proxy_Function_Base *func = nullptr;
+        try {
+          func = boxed_cast<const dispatch::Proxy_Function_Base *>(t_fn);
+        } catch (const exception::bad_boxed_cast &) {
+          return cache;
+        }
+
+        const auto *dynamic_func = dynamic_cast<const dispatch::Dynamic_Proxy_Function *>(func);
+        if (!dynamic_func || dynamic_func->has_guard() || dynamic_func->has_typed_params() || !dynamic_func->has_parse_tree()
+            || !dynamic_func->get_param_names() || dynamic_func->get_param_names()->size() != t_num_params
+            || dynamic_func->get_arity() != static_cast<int>(t_num_params)) {
+          return cache;
+        }
+
+        const auto *body = dynamic_cast<const AST_Node_Impl<T> *>(&dynamic_func->get_parse_tree());
+        std::size_t num_nodes = 0;
+        if (!body || !is_small_and_non_recursive(*body, num_nodes)) {
+          return cache;
+        }
+
+        cache.function = boxed_cast<Const_Proxy_Function>(t_fn);
+        cache.body = body;
+        cache.param_names = &*dynamic_func->get_param_names();
+        cache.on_callers_stack = only_uses_params(*body, *cache.param_names);
+        return cache;
+      }
+
+      bool is_small_and_non_recursive(const AST_Node_Impl<T> &t_node, std::size_t &t_num_nodes) const {
+        if (++t_num_nodes > max_inline_nodes) {
+          return false;
+        }
+
+        if (t_node.identifier == AST_Node_Type::Fun_Call && t_node.children[0]->identifier == AST_Node_Type::Id
+            && t_node.children[0]->text == this->children[0]->text) {
+          return false;
+        }
+
+        if (t_node.identifier == AST_Node_Type::Compiled
+            && !is_small_and_non_recursive(*static_cast<const Compiled_AST_Node<T> &>(t_node).m_original_node, t_num_nodes)) {
+          return false;
+        }
+
+        for (const auto &child : t_node.children) {
+          if (!is_small_and_non_recursive(*child, t_num_nodes)) {
+            return false;
+          }
+        }
+
+        return true;
+      }
+
+      /// True if every name the body looks up is one of the parameters, in which case
+      /// it cannot observe whether it runs on its own stack or on top of the caller's
+      static bool only_uses_params(const AST_Node_Impl<T> &t_node, const std::vector<std::string> &t_param_names) {
+        switch (t_node.identifier) {
+          case AST_Node_Type::Id:
+            return t_node.text != "this" && std::find(t_param_names.begin(), t_param_names.end(), t_node.text) != t_param_names.end();
+          case AST_Node_Type::Dot_Access:
+            // the member name is not looked up on the stack, only the object and the arguments are
+            if (!only_uses_params(*t_node.children[0], t_param_names)) {
+              return false;
+            } else if (t_node.children[1]->children.size() > 1) {
+              return only_uses_params(*t_node.children[1]->children[1], t_param_names);
+            } else {
+              return true;
+            }
+          case AST_Node_Type::Def:
+          case AST_Node_Type::Lambda:
+          case AST_Node_Type::Method:
+          case AST_Node_Type::Class:
+          case AST_Node_Type::Global_Decl:
+          case AST_Node_Type::Compiled:
+            return false;
+          default:
+            return std::all_of(t_node.children.begin(), t_node.children.end(), [&](const auto &child) {
+              return only_uses_params(*child, t_param_names);
+            });
+        }
+      }
+
+      /// Same as detail::eval_function, but with the parameters in a new scope on the current stack
+      static Boxed_Value eval_on_callers_stack(const AST_Node_Impl<T> &t_body,
+                                               const std::vector<std::string> &t_param_names,
+                                               const Function_Params &t_vals,
+                                               const chaiscript::detail::Dispatch_State &t_ss) {
+        // the body never reads `this`, but it is added just like eval_function does so that
+        // the parameters end up in the same slots, which is what their Id nodes cache
+        const auto thisobj = [&]() -> std::optional<Boxed_Value> {
+          if (auto &stack = t_ss->get_stack_data(t_ss.stack_holder()).back(); !stack.empty() && stack.back().first == "__this") {
+            return stack.back().second;
+          } else if (!t_vals.empty()) {
+            return t_vals[0];
+          } else {
+            return std::nullopt;
+          }
+        }();
+
+        chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
+        if (thisobj) {
+          t_ss.add_object("this", *thisobj);
+        }
+
+        for (size_t i = 0; i < t_param_names.size(); ++i) {
+          if (t_param_names[i] != "this") {
+            t_ss.add_object(t_param_names[i], t_vals[i]);
+          }
+        }
+
+        try {
+          return t_body.eval(t_ss);
+        } catch (detail::Return_Value &rv) {
+          return std::move(rv.retval);
+        }
+      }
+
+      mutable chaiscript::detail::threading::Thread_Storage<Inline_Cache> m_cache;
+    };
+
+    /// A call to a named function with only constant arguments, placed by optimizer::Fold_Pure_Call. When
+    /// every overload the arguments match was declared pure, see chaiscript::pure, the result is kept and
+    /// later evaluations return a copy of it without calling anything. Like Inline_Fun_Call_AST_Node, the
+    /// resolved function object is compared on every evaluation, so redefining, overloading or shadowing
+    /// the function makes the node call it again.
+    template<typename T>
+    struct Fold_Fun_Call_AST_Node final : Fun_Call_AST_Node<T> {
+      Fold_Fun_Call_AST_Node(std::string t_ast_node_text, Parse_Location t_loc, std::vector<AST_Node_Impl_Ptr<T>> t_children)
+          : Fun_Call_AST_Node<T>(std::move(t_ast_node_text), std::move(t_loc), std::move(t_children)) {
+        assert(this->children.size() == 2);
+        for (const auto &arg : this->children[1]->children) {
+          assert(arg->identifier == AST_Node_Type::Constant);
+          m_args.push_back(static_cast<const Constant_AST_Node<T> &>(*arg).m_value);
+        }
+      }
+
+      Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
+        Boxed_Value fn(this->children[0]->eval(t_ss));
+
+        auto &cache = *m_cache;
+        if (cache.identity == fn.get_const_ptr() && cache.value && !cache.function.expired()) {
+          return detail::copy_reusable_value(*cache.value);
+        }
+
+        chaiscript::eval::detail::Function_Push_Pop fpp(t_ss);
+        auto retval = this->template do_call<true>(t_ss, fpp, Function_Params{m_args}, fn);
+
+        // decided after the call, which is what tells a failed dispatch apart from a pure one
+        if (cache.identity != fn.get_const_ptr() || cache.function.expired()) {
+          Fold_Cache new_cache;
+          new_cache.identity = fn.get_const_ptr();
+          if (detail::is_reusable_value(retval) && is_pure_call(fn, t_ss)) {
+            new_cache.function = boxed_cast<Const_Proxy_Function>(fn);
+            new_cache.value = detail::copy_reusable_value(retval);
+          }
+          cache = std::move(new_cache);
+        }
+
+        return retval;
+      }
+
+    private:
+      struct Fold_Cache {
+        /// address of the function object last called through this node, tracked the same way as in
+        /// Inline_Fun_Call_AST_Node; value is only set when the call could be folded
+        const void *identity = nullptr;
+        std::weak_ptr<const dispatch::Proxy_Function_Base> function;
+        std::optional<Boxed_Value> value;
+      };
+
+      /// True if the call dispatches to a pure function, whichever of the matching overloads that is
+      bool is_pure_call(const Boxed_Value &t_fn, const chaiscript::detail::Dispatch_State &t_ss) const {
+        try {
+          const auto *func = boxed_cast<const dispatch::Proxy_Function_Base *>(t_fn);
+          if (func->is_pure()) {
+            return true;
+          } else if (!dynamic_cast<const chaiscript::detail::Dispatch_Function *>(func)) {
+            return false;
+          }
+
+          bool matched = false;
+          for (const auto &overload : func->get_contained_functions()) {
+            if (overload->call_match(Function_Params{m_args}, t_ss.conversions())) {
+              if (!overload->is_pure()) {
+                return false;
+              }
+              matched = true;
+            }
+          }
+          // without an exact match, dispatch picks an overload by arithmetic conversions
+          return matched;
+        } catch (const std::exception &) {
+          return false;
+        }
+      }
+
+      std::vector<Boxed_Value> m_args;
+      mutable chaiscript::detail::threading::Thread_Storage<Fold_Cache> m_cache;
+    };
+
+    /// A call, in tail position, of the `def` whose body contains it, by the function's own name. Placed by
+    /// optimizer::Tail_Call. If the name still resolves to that function and the arguments pass its parameter
+    /// types and guard, the node evaluates to a detail::Tail_Call holding them and detail::eval_def evaluates the
+    /// body again, so the recursion neither grows the C++ stack nor the script's call stack. Anything else,
+    /// such as an overloaded name, is called as usual.
+    template<typename T>
+    struct Tail_Fun_Call_AST_Node final : Fun_Call_AST_Node<T> {
+      Tail_Fun_Call_AST_Node(std::string t_ast_node_text,
+                             Parse_Location t_loc,
+                             std::vector<AST_Node_Impl_Ptr<T>> t_children,
+                             const AST_Node_Impl<T> &t_body)
+          : Fun_Call_AST_Node<T>(std::move(t_ast_node_text), std::move(t_loc), std::move(t_children))
+          , m_body(t_body) {
+        assert(this->children.size() == 2);
+      }
+
+      Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
+        chaiscript::eval::detail::Function_Push_Pop fpp(t_ss);
+
+        std::vector<Boxed_Value> params;
+        params.reserve(this->children[1]->children.size());
+        for (const auto &child : this->children[1]->children) {
+          params.push_back(child->eval(t_ss));
+        }
+
+        Boxed_Value fn(this->children[0]->eval(t_ss));
+        if (const auto *func = own_function(fn)) {
+          try {
+            return Boxed_Value(detail::Tail_Call{func->checked_params(Function_Params{params}, t_ss.conversions())});
+          } catch (const exception::guard_error &) {
+            // the regular call reports it
+          }
+        }
+
+        return this->template do_call<true>(t_ss, fpp, Function_Params{params}, fn);
+      }
+
+    private:
+      /// The function fn refers to, if it is the one whose body contains this node
+      const dispatch::Dynamic_Proxy_Function *own_function(const Boxed_Value &fn) const {
+        const dispatch::Proxy_Function_Base *func = nullptr;
+        try {
+          func = boxed_cast<const dispatch::Proxy_Function_Base *>(fn);
+        } catch (const exception::bad_boxed_cast &) {
+          return nullptr;
+        }
+
+        // a def with typed arithmetic parameters is wrapped on its own
+        if (const auto *dispatch_func = dynamic_cast<const chaiscript::detail::Dispatch_Function *>(func)) {
+          const auto &funcs = dispatch_func->get_functions();
+          if (funcs.size() != 1) {
+            return nullptr;
+          }
+          func = funcs.front().get();
+        }
+
+        const auto *dynamic_func = dynamic_cast<const dispatch::Dynamic_Proxy_Function *>(func);
+        if (dynamic_func && dynamic_func->has_parse_tree() && &dynamic_func->get_parse_tree() == &m_body) {
+          return dynamic_func;
+        } else {
+          return nullptr;
+        }
+      }
+
+      const AST_Node_Impl<T> &m_body;
+    };
+
     template<typename T>
     struct Arg_AST_Node final : AST_Node_Impl<T> {
       Arg_AST_Node(std::string t_ast_node_text, Parse_Location t_loc, std::vector<AST_Node_Impl_Ptr<T>> t_children)
@@ -410,13 +849,25 @@ namespace chaiscript {
     struct Equation_AST_Node final : AST_Node_Impl<T> {
       Equation_AST_Node(std::string t_ast_node_text, Parse_Location t_loc, std::vector<AST_Node_Impl_Ptr<T>> t_children)
           : AST_Node_Impl<T>(std::move(t_ast_node_text), AST_Node_Type::Equation, std::move(t_loc), std::move(t_children))
-          , m_oper(Operators::to_operator(this->text)) {
+          , m_oper(Operators::to_operator(this->text))
+          , m_name(this->text) {
         assert(this->children.size() == 2);
       }
 
+      /// Set by optimizer::Append_Assign on `x = x + a + b ...`, where the left end of the sum is the variable
+      /// assigned to. When that holds a string, and so does each value added, they are appended to it in place
+      /// instead of being added up into new strings that are then copied back.
+      bool m_appends = false;
+
       Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
         chaiscript::eval::detail::Function_Push_Pop fpp(t_ss);
 
+        if (m_appends) {
+          if (auto retval = append_in_place(t_ss)) {
+            return std::move(*retval);
+          }
+        }
+
         auto params = [&]() {
           // The RHS *must* be evaluated before the LHS
           // consider `var range = range(x)`
@@ -459,7 +910,7 @@ namespace chaiscript {
             }
 
             try {
-              return t_ss->call_function(this->text, m_loc, Function_Params{params}, t_ss.conversions());
+              return t_ss->call_function(m_name, m_loc, Function_Params{params}, t_ss.conversions());
             } catch (const exception::dispatch_error &e) {
               throw exception::eval_error("Unable to find appropriate'" + this->text + "' operator.", e.parameters, e.functions, false, *t_ss);
             }
@@ -479,7 +930,7 @@ namespace chaiscript {
           }
         } else {
           try {
-            return t_ss->call_function(this->text, m_loc, Function_Params{params}, t_ss.conversions());
+            return t_ss->call_function(m_name, m_loc, Function_Params{params}, t_ss.conversions());
           } catch (const exception::dispatch_error &e) {
             throw exception::eval_error("Unable to find appropriate'" + this->text + "' operator.", e.parameters, e.functions, false, *t_ss);
           }
@@ -489,7 +940,71 @@ namespace chaiscript {
       }
 
     private:
+      /// `x = x + a + b ...` for a string x, or nothing if x is not a string that can be assigned to, in which case
+      /// nothing has been evaluated but x itself
+      std::optional<Boxed_Value> append_in_place(const chaiscript::detail::Dispatch_State &t_ss) const {
+        // the sums from the innermost out, each adding one piece to the one before
+        std::vector<const Binary_Operator_AST_Node<T> *> sums;
+        const AST_Node_Impl<T> *node = this->children[1].get();
+        while (node->identifier == AST_Node_Type::Binary && node->text == "+") {
+          const auto *sum = dynamic_cast<const Binary_Operator_AST_Node<T> *>(node);
+          if (sum == nullptr) {
+            return std::nullopt;
+          }
+          sums.push_back(sum);
+          node = sum->children[0].get();
+        }
+        if (sums.empty() || node->identifier != AST_Node_Type::Id || node->text != this->children[0]->text) {
+          return std::nullopt;
+        }
+        std::reverse(sums.begin(), sums.end());
+
+        auto lhs = this->children[0]->eval(t_ss);
+        if (lhs.is_const() || lhs.is_return_value() || !lhs.get_type_info().bare_equal_type_info(typeid(std::string))) {
+          return std::nullopt;
+        }
+
+        std::vector<Boxed_Value> pieces;
+        pieces.reserve(sums.size());
+        for (const auto *sum : sums) {
+          auto piece = sum->children[1]->eval(t_ss);
+          if (!piece.get_type_info().bare_equal_type_info(typeid(std::string))) {
+            // not all strings: add up the rest as the sums would have, from the pieces evaluated so far
+            Boxed_Value retval = lhs;
+            for (std::size_t i = 0; i < pieces.size(); ++i) {
+              retval = sums[i]->apply(t_ss, retval, pieces[i]);
+            }
+            retval = sums[pieces.size()]->apply(t_ss, retval, piece);
+            for (std::size_t i = pieces.size() + 1; i < sums.size(); ++i) {
+              retval = sums[i]->apply(t_ss, retval, sums[i]->children[1]->eval(t_ss));
+            }
+
+            std::array<Boxed_Value, 2> params{std::move(lhs), std::move(retval)};
+            try {
+              return t_ss->call_function(m_name, m_loc, Function_Params{params}, t_ss.conversions());
+            } catch (const exception::dispatch_error &e) {
+              throw exception::eval_error("Unable to find appropriate'" + this->text + "' operator.", e.parameters, e.functions, false, *t_ss);
+            }
+          }
+          pieces.push_back(std::move(piece));
+        }
+
+        auto &target = *static_cast<std::string *>(lhs.get_ptr());
+        for (auto &piece : pieces) {
+          if (piece.get_const_ptr() == lhs.get_const_ptr()) {
+            // x = x + x: keep the value the piece had before anything is appended to it
+            piece = Boxed_Value(target);
+          }
+        }
+
+        for (const auto &piece : pieces) {
+          target += *static_cast<const std::string *>(piece.get_const_ptr());
+        }
+        return lhs;
+      }
+
       Operators::Opers m_oper;
+      utility::Interned_String m_name;
       mutable std::atomic_uint_fast32_t m_loc = {0};
       mutable std::atomic_uint_fast32_t m_clone_loc = {0};
     };
@@ -567,8 +1082,9 @@ namespace chaiscript {
         std::array<Boxed_Value, 2> params{this->children[0]->eval(t_ss), this->children[1]->eval(t_ss)};
 
         try {
-          fpp.save_params(Function_Params{params});
-          return t_ss->call_function("[]", m_loc, Function_Params{params}, t_ss.conversions());
+          auto retval = t_ss->call_function(detail::index_operator_name(), m_loc, Function_Params{params}, t_ss.conversions());
+          fpp.save_params(Function_Params{params}, retval);
+          return retval;
         } catch (const exception::dispatch_error &e) {
           throw exception::eval_error("Can not find appropriate array lookup operator '[]'.", e.parameters, e.functions, false, *t_ss);
         }
@@ -584,13 +1100,24 @@ namespace chaiscript {
           : AST_Node_Impl<T>(std::move(t_ast_node_text), AST_Node_Type::Dot_Access, std::move(t_loc), std::move(t_children))
           , m_fun_name(((this->children[1]->identifier == AST_Node_Type::Fun_Call) || (this->children[1]->identifier == AST_Node_Type::Array_Call))
                            ? this->children[1]->children[0]->text
-                           : this->children[1]->text) {
+                           : this->children[1]->text)
+          , m_is_attr_access((this->children[1]->identifier != AST_Node_Type::Fun_Call)
+                             && (this->children[1]->identifier != AST_Node_Type::Array_Call)) {
       }
 
       Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
         chaiscript::eval::detail::Function_Push_Pop fpp(t_ss);
 
         Boxed_Value retval = this->children[0]->eval(t_ss);
+
+        const auto *obj = m_is_attr_access ? attr_cache_object(retval) : nullptr;
+        if (obj) {
+          const auto &cache = *m_attr_cache;
+          if (cache.engine == &*t_ss && cache.generation == t_ss->function_generation() && cache.shape.get() == obj->get_shape()) {
+            return obj->get_slot(cache.slot);
+          }
+        }
+
         auto params = make_vector(retval);
 
         bool has_function_params = false;
@@ -601,10 +1128,8 @@ namespace chaiscript {
           }
         }
 
-        fpp.save_params(Function_Params{params});
-
         try {
-          retval = t_ss->call_member(m_fun_name, m_loc, Function_Params{params}, has_function_params, t_ss.conversions());
+          retval = t_ss->call_member(m_interned_fun_name.get(m_fun_name), m_loc, Function_Params{params}, has_function_params, t_ss.conversions());
         } catch (const exception::dispatch_error &e) {
           if (e.functions.empty()) {
             throw exception::eval_error("'" + m_fun_name + "' is not a function.");
@@ -615,10 +1140,16 @@ namespace chaiscript {
           retval = std::move(rv.retval);
         }
 
+        fpp.save_params(Function_Params{params}, retval);
+
+        if (obj) {
+          update_attr_cache(t_ss, *obj, params.front(), retval);
+        }
+
         if (this->children[1]->identifier == AST_Node_Type::Array_Call) {
           try {
             std::array<Boxed_Value, 2> p{retval, this->children[1]->children[1]->eval(t_ss)};
-            retval = t_ss->call_function("[]", m_array_loc, Function_Params{p}, t_ss.conversions());
+            retval = t_ss->call_function(detail::index_operator_name(), m_array_loc, Function_Params{p}, t_ss.conversions());
           } catch (const exception::dispatch_error &e) {
             throw exception::eval_error("Can not find appropriate array lookup operator '[]'.", e.parameters, e.functions, true, *t_ss);
           }
@@ -628,9 +1159,62 @@ namespace chaiscript {
       }
 
     private:
+      /// Where a plain `obj.name` read last found its value: the slot of `name` in objects of
+      /// `shape`, valid while the function table of `engine` has not changed since `generation`
+      struct Attr_Cache {
+        const chaiscript::detail::Dispatch_Engine *engine = nullptr;
+        uint_fast32_t generation = 0;
+        std::shared_ptr<const dispatch::Dynamic_Object_Shape> shape;
+        std::size_t slot = 0;
+      };
+
+      /// \returns the object if t_bv is a non-const Dynamic_Object, the only case the attribute cache handles
+      static const dispatch::Dynamic_Object *attr_cache_object(const Boxed_Value &t_bv) noexcept {
+        if (!t_bv.is_const() && t_bv.get_type_info().bare_equal(user_type<dispatch::Dynamic_Object>())) {
+          return static_cast<const dispatch::Dynamic_Object *>(t_bv.get_const_ptr());
+        } else {
+          return nullptr;
+        }
+      }
+
+      /// Remember the slot that a read went to, but only if every function of this name is an
+      /// attribute accessor and one of them applies to the object, so that the same read on
+      /// any other object with the same shape is guaranteed to go to the same slot.
+      void update_attr_cache(const chaiscript::detail::Dispatch_State &t_ss,
+                             const dispatch::Dynamic_Object &t_obj,
+                             const Boxed_Value &t_obj_bv,
+                             const Boxed_Value &t_result) const {
+        const auto generation = t_ss->function_generation();
+        const auto fun_name = m_interned_fun_name.get(m_fun_name);
+        const auto funs = t_ss->get_function(fun_name, m_loc).second;
+
+        const bool only_attributes = !funs->empty() && std::all_of(funs->begin(), funs->end(), [](const auto &f) {
+          return f->is_attribute_function();
+        });
+
+        if (!only_attributes
+            || std::none_of(funs->begin(), funs->end(), [&](const auto &f) { return f->compare_first_type(t_obj_bv, t_ss.conversions()); })) {
+          return;
+        }
+
+        const auto slot = t_obj.get_shape()->index_of(fun_name);
+        if (slot == dispatch::Dynamic_Object_Shape::npos || t_result.is_undef() || t_obj.get_slot(slot).get_const_ptr() != t_result.get_const_ptr()) {
+          return;
+        }
+
+        auto &cache = *m_attr_cache;
+        cache.engine = &*t_ss;
+        cache.generation = generation;
+        cache.shape = t_obj.get_shape_ptr();
+        cache.slot = slot;
+      }
+
       mutable std::atomic_uint_fast32_t m_loc = {0};
       mutable std::atomic_uint_fast32_t m_array_loc = {0};
       const std::string m_fun_name;
+      utility::Lazy_Interned_String m_interned_fun_name;
+      const bool m_is_attr_access;
+      mutable chaiscript::detail::threading::Thread_Storage<Attr_Cache> m_attr_cache;
     };
 
     template<typename T>
@@ -643,17 +1227,25 @@ namespace chaiscript {
                                                                std::make_move_iterator(std::prev(t_children.end()))))
           , m_param_names(Arg_List_AST_Node<T>::get_arg_names(*this->children[1]))
           , m_this_capture(has_this_capture(this->children[0]->children))
+          , m_captured(captured(this->children[0]->children))
+          , m_distinct_names(distinct_names(this->children[0]->children, m_captured, m_param_names))
           , m_lambda_node(std::move(t_children.back())) {
       }
 
       Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
-        const auto captures = [&]() -> std::map<std::string, Boxed_Value> {
-          std::map<std::string, Boxed_Value> named_captures;
-          for (const auto &capture : this->children[0]->children) {
-            named_captures.insert(std::make_pair(capture->children[0]->text, capture->children[0]->eval(t_ss)));
+        chaiscript::detail::Stack_Holder::Captures values;
+        values.reserve(m_captured.size());
+        for (size_t i = 0; i < this->children[0]->children.size(); ++i) {
+          const auto &capture = *this->children[0]->children[i]->children[0];
+          auto value = capture.eval(t_ss);
+          if (std::binary_search(m_captured.begin(), m_captured.end(), i)) {
+            values.emplace_back(capture.text, std::move(value));
           }
-          return named_captures;
-        }();
+        }
+
+        detail::Captures captures;
+        captures.values = std::make_shared<const chaiscript::detail::Stack_Holder::Captures>(std::move(values));
+        captures.distinct_names = m_distinct_names;
 
         const auto numparams = this->children[1]->children.size();
         const auto param_types = Arg_List_AST_Node<T>::get_arg_types(*this->children[1], t_ss);
@@ -661,8 +1253,11 @@ namespace chaiscript {
         std::reference_wrapper<chaiscript::detail::Dispatch_Engine> engine(*t_ss);
 
         return Boxed_Value(dispatch::make_dynamic_proxy_function(
-            [engine, lambda_node = this->m_lambda_node, param_names = this->m_param_names, captures, this_capture = this->m_this_capture](
-                const Function_Params &t_params) {
+            [engine,
+             lambda_node = this->m_lambda_node,
+             param_names = this->m_param_names,
+             captures = std::move(captures),
+             this_capture = this->m_this_capture](const Function_Params &t_params) {
               return detail::eval_function(engine, *lambda_node, param_names, t_params, &captures, this_capture);
             },
             static_cast<int>(numparams),
@@ -675,8 +1270,39 @@ namespace chaiscript {
       }
 
     private:
+      /// Indices of the captures that are kept, the first of each name
+      static std::vector<size_t> captured(const std::vector<AST_Node_Impl_Ptr<T>> &t_captures) {
+        std::vector<size_t> result;
+        for (size_t i = 0; i < t_captures.size(); ++i) {
+          const auto &name = t_captures[i]->children[0]->text;
+          if (std::none_of(result.begin(), result.end(), [&](const size_t j) { return t_captures[j]->children[0]->text == name; })) {
+            result.push_back(i);
+          }
+        }
+        return result;
+      }
+
+      static bool distinct_names(const std::vector<AST_Node_Impl_Ptr<T>> &t_captures,
+                                 const std::vector<size_t> &t_captured,
+                                 const std::vector<std::string> &t_param_names) {
+        std::vector<std::string> names;
+        for (const auto i : t_captured) {
+          names.push_back(t_captures[i]->children[0]->text);
+        }
+        for (const auto &param : t_param_names) {
+          if (param != "this") {
+            names.push_back(param);
+          }
+        }
+
+        std::sort(names.begin(), names.end());
+        return std::adjacent_find(names.begin(), names.end()) == names.end();
+      }
+
       const std::vector<std::string> m_param_names;
       const bool m_this_capture = false;
+      const std::vector<size_t> m_captured;
+      const bool m_distinct_names = false;
       const std::shared_ptr<AST_Node_Impl<T>> m_lambda_node;
     };
 
@@ -783,12 +1409,13 @@ namespace chaiscript {
           const std::string &l_function_name = this->children[0]->text;
           t_ss->add(dispatch::make_dynamic_proxy_function(
                         [engine, func_node = m_body_node, t_param_names](const Function_Params &t_params) {
-                          return detail::eval_function(engine, *func_node, t_param_names, t_params);
+                          return detail::eval_def(engine, *func_node, t_param_names, t_params);
                         },
                         static_cast<int>(numparams),
                         m_body_node,
                         param_types,
-                        guard),
+                        guard,
+                        t_param_names),
                     l_function_name);
         } catch (const exception::name_conflict_error &e) {
           throw exception::eval_error("Function redefined '" + e.name() + "'");
@@ -883,56 +1510,58 @@ namespace chaiscript {
         const std::string &loop_var_name = this->children[0]->text;
         Boxed_Value range_expression_result = this->children[1]->eval(t_ss);
 
-        const auto do_loop = [&loop_var_name, &t_ss, this](const auto &ranged_thing) {
+        // One scope holds the loop variable for the whole loop, and each element is bound to it in turn.
+        // A lambda capturing the variable keeps the element it was made with.
+        chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
+        bool bound = false;
+        const auto run_body = [&](Boxed_Value t_value) {
+          if (bound) {
+            t_ss.rebind_scope_object(std::move(t_value));
+          } else {
+            t_ss.add_object(loop_var_name, std::move(t_value));
+            bound = true;
+          }
+
           try {
-            for (auto &&loop_var : ranged_thing) {
-              // This scope push and pop might not be the best thing for perf
-              // but we know it's 100% correct
-              chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
-              /// to-do make this if-constexpr with C++17 branch
-              if (!std::is_same<std::decay_t<decltype(loop_var)>, Boxed_Value>::value) {
-                t_ss.add_get_object(loop_var_name, Boxed_Value(std::ref(loop_var)));
-              } else {
-                t_ss.add_get_object(loop_var_name, Boxed_Value(loop_var));
-              }
-              try {
-                this->children[2]->eval(t_ss);
-              } catch (detail::Continue_Loop &) {
-              }
-            }
-          } catch (detail::Break_Loop &) {
-            // loop broken
+            this->children[2]->eval(t_ss);
+          } catch (detail::Continue_Loop &) {
+            // continue statement hit
           }
-          return void_var();
         };
 
-        if (range_expression_result.get_type_info().bare_equal_type_info(typeid(std::vector<Boxed_Value>))) {
-          return do_loop(boxed_cast<const std::vector<Boxed_Value> &>(range_expression_result));
-        } else if (range_expression_result.get_type_info().bare_equal_type_info(typeid(std::map<std::string, Boxed_Value>))) {
-          return do_loop(boxed_cast<const std::map<std::string, Boxed_Value> &>(range_expression_result));
-        } else {
-          const auto range_funcs = get_function("range", m_range_loc);
-          const auto empty_funcs = get_function("empty", m_empty_loc);
-          const auto front_funcs = get_function("front", m_front_loc);
-          const auto pop_front_funcs = get_function("pop_front", m_pop_front_loc);
+        try {
+          const auto &type = range_expression_result.get_type_info();
+          if (type.bare_equal_type_info(typeid(std::vector<Boxed_Value>))) {
+            for (const auto &elem : boxed_cast<const std::vector<Boxed_Value> &>(range_expression_result)) {
+              run_body(elem);
+            }
+          } else if (type.bare_equal_type_info(typeid(std::map<std::string, Boxed_Value>))) {
+            for (const auto &elem : boxed_cast<const std::map<std::string, Boxed_Value> &>(range_expression_result)) {
+              run_body(Boxed_Value(std::ref(elem)));
+            }
+          } else if (type.bare_equal_type_info(typeid(dispatch::Integral_Range))) {
+            for (auto range = boxed_cast<dispatch::Integral_Range>(range_expression_result); !range.empty(); range.pop_front()) {
+              run_body(range.front());
+            }
+          } else if (const auto iteration = t_ss->get_native_iteration(type)) {
+            iteration->for_each(range_expression_result, run_body);
+          } else {
+            const auto range_funcs = get_function("range", m_range_loc);
+            const auto empty_funcs = get_function("empty", m_empty_loc);
+            const auto front_funcs = get_function("front", m_front_loc);
+            const auto pop_front_funcs = get_function("pop_front", m_pop_front_loc);
 
-          try {
             const auto range_obj = call_function(range_funcs, range_expression_result);
             while (!boxed_cast<bool>(call_function(empty_funcs, range_obj))) {
-              chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
-              t_ss.add_get_object(loop_var_name, call_function(front_funcs, range_obj));
-              try {
-                this->children[2]->eval(t_ss);
-              } catch (detail::Continue_Loop &) {
-                // continue statement hit
-              }
+              run_body(call_function(front_funcs, range_obj));
               call_function(pop_front_funcs, range_obj);
             }
-          } catch (detail::Break_Loop &) {
-            // loop broken
           }
-          return void_var();
+        } catch (detail::Break_Loop &) {
+          // loop broken
         }
+
+        return void_var();
       }
 
     private:
@@ -978,29 +1607,45 @@ namespace chaiscript {
       }
 
       Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
-        bool breaking = false;
-        size_t currentCase = 1;
-        bool hasMatched = false;
-
         chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
 
         Boxed_Value match_value(this->children[0]->eval(t_ss));
 
-        while (!breaking && (currentCase < this->children.size())) {
+        eval_cases(*this, 1, false, match_value, m_loc, t_ss);
+        return void_var();
+      }
+
+      /// Runs the cases of t_switch from t_first on: a case whose label equals t_match_value and everything after it
+      /// falls through to, until a `break`. With t_matched set, every case from t_first on runs
+      static void eval_cases(const AST_Node_Impl<T> &t_switch,
+                             size_t t_first,
+                             bool t_matched,
+                             const Boxed_Value &t_match_value,
+                             std::atomic_uint_fast32_t &t_loc,
+                             const chaiscript::detail::Dispatch_State &t_ss) {
+        bool breaking = false;
+        size_t currentCase = t_first;
+        bool hasMatched = t_matched;
+
+        while (!breaking && (currentCase < t_switch.children.size())) {
           try {
-            if (this->children[currentCase]->identifier == AST_Node_Type::Case) {
+            if (t_switch.children[currentCase]->identifier == AST_Node_Type::Case) {
               // This is a little odd, but because want to see both the switch and the case simultaneously, I do a downcast here.
               try {
-                std::array<Boxed_Value, 2> p{match_value, this->children[currentCase]->children[0]->eval(t_ss)};
-                if (hasMatched || boxed_cast<bool>(t_ss->call_function("==", m_loc, Function_Params{p}, t_ss.conversions()))) {
-                  this->children[currentCase]->eval(t_ss);
-                  hasMatched = true;
+                if (hasMatched) {
+                  t_switch.children[currentCase]->eval(t_ss);
+                } else {
+                  std::array<Boxed_Value, 2> p{t_match_value, t_switch.children[currentCase]->children[0]->eval(t_ss)};
+                  if (boxed_cast<bool>(t_ss->call_function("==", t_loc, Function_Params{p}, t_ss.conversions()))) {
+                    t_switch.children[currentCase]->eval(t_ss);
+                    hasMatched = true;
+                  }
                 }
               } catch (const exception::bad_boxed_cast &) {
                 throw exception::eval_error("Internal error: case guard evaluation not boolean");
               }
-            } else if (this->children[currentCase]->identifier == AST_Node_Type::Default) {
-              this->children[currentCase]->eval(t_ss);
+            } else if (t_switch.children[currentCase]->identifier == AST_Node_Type::Default) {
+              t_switch.children[currentCase]->eval(t_ss);
               hasMatched = true;
             }
           } catch (detail::Break_Loop &) {
@@ -1008,9 +1653,94 @@ namespace chaiscript {
           }
           ++currentCase;
         }
+      }
+
+      mutable std::atomic_uint_fast32_t m_loc = {0};
+    };
+
+    /// A `switch` whose case labels are all int constants or all string constants, see optimizer::Switch.
+    ///
+    /// An int or string value jumps straight to the first case with an equal label, or to the first `default`
+    /// if that comes earlier, and falls through from there as a `switch` does. Ints use a table indexed by the
+    /// label when the labels are dense and a hash table otherwise. A value of any other type is compared
+    /// case by case with `==`, as in Switch_AST_Node.
+    template<typename T>
+    struct Table_Switch_AST_Node final : AST_Node_Impl<T> {
+      Table_Switch_AST_Node(std::string t_ast_node_text, Parse_Location t_loc, std::vector<AST_Node_Impl_Ptr<T>> t_children)
+          : AST_Node_Impl<T>(std::move(t_ast_node_text), AST_Node_Type::Switch, std::move(t_loc), std::move(t_children))
+          , m_default(this->children.size()) {
+        std::vector<std::pair<int, size_t>> int_cases;
+        for (size_t i = 1; i < this->children.size(); ++i) {
+          const auto &child = *this->children[i];
+          if (child.identifier == AST_Node_Type::Default) {
+            m_default = std::min(m_default, i);
+          } else {
+            const auto &label = dynamic_cast<const Constant_AST_Node<T> &>(*child.children[0]).m_value;
+            if (label.get_type_info().bare_equal_type_info(typeid(int))) {
+              int_cases.emplace_back(*static_cast<const int *>(label.get_const_ptr()), i);
+            } else {
+              m_string_cases.emplace(*static_cast<const std::string *>(label.get_const_ptr()), i);
+            }
+          }
+        }
+
+        if (!int_cases.empty()) {
+          const auto [min, max] = std::minmax_element(int_cases.begin(), int_cases.end());
+          const auto span = static_cast<long long>(max->first) - min->first + 1;
+          if (span <= static_cast<long long>(int_cases.size()) * 4 + 8) {
+            m_dense_min = min->first;
+            m_dense_cases.assign(static_cast<size_t>(span), this->children.size());
+            // walk backwards so that the first of duplicate labels wins
+            for (auto itr = int_cases.rbegin(); itr != int_cases.rend(); ++itr) {
+              m_dense_cases[static_cast<size_t>(static_cast<long long>(itr->first) - m_dense_min)] = itr->second;
+            }
+          } else {
+            for (const auto &[label, index] : int_cases) {
+              m_int_cases.emplace(label, index);
+            }
+          }
+        }
+      }
+
+      Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
+        chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
+
+        Boxed_Value match_value(this->children[0]->eval(t_ss));
+
+        const auto &type = match_value.get_type_info();
+        if (type.bare_equal_type_info(typeid(int)) && (!m_dense_cases.empty() || !m_int_cases.empty())) {
+          jump(find_case(*static_cast<const int *>(match_value.get_const_ptr())), match_value, t_ss);
+        } else if (type.bare_equal_type_info(typeid(std::string)) && !m_string_cases.empty()) {
+          const auto itr = m_string_cases.find(*static_cast<const std::string *>(match_value.get_const_ptr()));
+          jump(itr == m_string_cases.end() ? this->children.size() : itr->second, match_value, t_ss);
+        } else {
+          Switch_AST_Node<T>::eval_cases(*this, 1, false, match_value, m_loc, t_ss);
+        }
+
         return void_var();
       }
 
+    private:
+      size_t find_case(int t_value) const {
+        if (!m_dense_cases.empty()) {
+          const auto offset = static_cast<long long>(t_value) - m_dense_min;
+          return (offset >= 0 && offset < static_cast<long long>(m_dense_cases.size())) ? m_dense_cases[static_cast<size_t>(offset)]
+                                                                                         : this->children.size();
+        } else {
+          const auto itr = m_int_cases.find(t_value);
+          return itr == m_int_cases.end() ? this->children.size() : itr->second;
+        }
+      }
+
+      void jump(size_t t_case, const Boxed_Value &t_match_value, const chaiscript::detail::Dispatch_State &t_ss) const {
+        Switch_AST_Node<T>::eval_cases(*this, std::min(t_case, m_default), true, t_match_value, m_loc, t_ss);
+      }
+
+      size_t m_default;
+      long long m_dense_min = 0;
+      std::vector<size_t> m_dense_cases;
+      std::unordered_map<int, size_t> m_int_cases;
+      std::unordered_map<std::string, size_t> m_string_cases;
       mutable std::atomic_uint_fast32_t m_loc = {0};
     };
 
@@ -1078,15 +1808,26 @@ namespace chaiscript {
       }
 
       Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
-        try {
-          std::map<std::string, Boxed_Value> retval;
+        return const_var(build(std::map<std::string, Boxed_Value>(), t_ss));
+      }
+
+      /// The Hash_Map the standard library's `Hash_Map` constructor would make of this literal, see Hash_Map_Call_AST_Node
+      Boxed_Value eval_hashed(const chaiscript::detail::Dispatch_State &t_ss) const {
+        std::unordered_map<std::string, Boxed_Value> retval;
+        retval.reserve(this->children[0]->children.size());
+        return Boxed_Value(build(std::move(retval), t_ss), true);
+      }
 
+    private:
+      template<typename Map>
+      Map build(Map t_map, const chaiscript::detail::Dispatch_State &t_ss) const {
+        try {
           for (const auto &child : this->children[0]->children) {
-            retval.insert(std::make_pair(t_ss->boxed_cast<std::string>(child->children[0]->eval(t_ss)),
-                                         detail::clone_if_necessary(child->children[1]->eval(t_ss), m_loc, t_ss)));
+            t_map.insert(std::make_pair(t_ss->boxed_cast<std::string>(child->children[0]->eval(t_ss)),
+                                        detail::clone_if_necessary(child->children[1]->eval(t_ss), m_loc, t_ss)));
           }
 
-          return const_var(std::move(retval));
+          return t_map;
         } catch (const exception::dispatch_error &e) {
           throw exception::eval_error("Can not find appropriate copy constructor or 'clone' while inserting into Map.",
                                       e.parameters,
@@ -1096,10 +1837,88 @@ namespace chaiscript {
         }
       }
 
-    private:
       mutable std::atomic_uint_fast32_t m_loc = {0};
     };
 
+    /// A `Hash_Map(...)` call whose only argument is a map literal, placed by optimizer::Hash_Map_Literal. When the
+    /// name resolves to the standard library's Hash_Map constructors, which only copy or convert the map they are
+    /// given, the literal builds the Hash_Map the call would return, instead of a Map that the call then converts.
+    /// Anything else, such as a script's own `Hash_Map`, is called as usual with a Map.
+    template<typename T>
+    struct Hash_Map_Call_AST_Node final : Fun_Call_AST_Node<T> {
+      Hash_Map_Call_AST_Node(std::string t_ast_node_text, Parse_Location t_loc, std::vector<AST_Node_Impl_Ptr<T>> t_children)
+          : Fun_Call_AST_Node<T>(std::move(t_ast_node_text), std::move(t_loc), std::move(t_children)) {
+        assert(this->children.size() == 2 && this->children[1]->children.size() == 1
+               && this->children[1]->children[0]->identifier == AST_Node_Type::Inline_Map);
+      }
+
+      Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
+        Boxed_Value fn(this->children[0]->eval(t_ss));
+
+        auto &cache = *m_cache;
+        if (cache.identity != fn.get_const_ptr() || cache.function.expired()) {
+          cache = resolve(fn, t_ss);
+        }
+
+        const auto &literal = static_cast<const Inline_Map_AST_Node<T> &>(*this->children[1]->children[0]);
+        if (cache.builds_hash_map) {
+          return literal.eval_hashed(t_ss);
+        }
+
+        chaiscript::eval::detail::Function_Push_Pop fpp(t_ss);
+        std::array<Boxed_Value, 1> params{literal.eval(t_ss)};
+        return this->template do_call<true>(t_ss, fpp, Function_Params{params}, fn);
+      }
+
+    private:
+      struct Constructor_Cache {
+        /// address of the function object last called through this node, which is replaced whenever an
+        /// overload is added; the weak reference tells a live function from a new one at the same address
+        const void *identity = nullptr;
+        std::weak_ptr<const dispatch::Proxy_Function_Base> function;
+        bool builds_hash_map = false;
+      };
+
+      static Constructor_Cache resolve(const Boxed_Value &t_fn, const chaiscript::detail::Dispatch_State &t_ss) {
+        Constructor_Cache cache;
+        cache.identity = t_fn.get_const_ptr();
+
+        Const_Proxy_Function func;
+        try {
+          func = boxed_cast<Const_Proxy_Function>(t_fn);
+        } catch (const exception::bad_boxed_cast &) {
+          return cache;
+        }
+        cache.function = func;
+
+        using Hash_Map = std::unordered_map<std::string, Boxed_Value>;
+        if (!t_ss->get_type("Hash_Map", false).bare_equal(user_type<Hash_Map>())) {
+          return cache;
+        }
+
+        std::vector<Const_Proxy_Function> overloads;
+        if (const auto *dispatch_func = dynamic_cast<const chaiscript::detail::Dispatch_Function *>(func.get())) {
+          overloads.assign(dispatch_func->get_functions().begin(), dispatch_func->get_functions().end());
+        } else {
+          overloads.push_back(func);
+        }
+
+        cache.builds_hash_map = std::all_of(overloads.begin(), overloads.end(), [](const Const_Proxy_Function &t_overload) {
+          if (t_overload->get_arity() == 0 || t_overload->get_arity() > 1) {
+            return true;
+          }
+
+          const auto *dynamic_func = dynamic_cast<const dispatch::Dynamic_Proxy_Function *>(t_overload.get());
+          const auto &types = t_overload->get_param_types();
+          return !(dynamic_func && dynamic_func->has_parse_tree()) && types.size() == 2
+              && (types[1].bare_equal(user_type<Hash_Map>()) || types[1].bare_equal(user_type<std::map<std::string, Boxed_Value>>()));
+        });
+        return cache;
+      }
+
+      mutable chaiscript::detail::threading::Thread_Storage<Constructor_Cache> m_cache;
+    };
+
     template<typename T>
     struct Return_AST_Node final : AST_Node_Impl<T> {
       Return_AST_Node(std::string t_ast_node_text, Parse_Location t_loc, std::vector<AST_Node_Impl_Ptr<T>> t_children)
@@ -1159,7 +1978,8 @@ namespace chaiscript {
     struct Prefix_AST_Node final : AST_Node_Impl<T> {
       Prefix_AST_Node(std::string t_ast_node_text, Parse_Location t_loc, std::vector<AST_Node_Impl_Ptr<T>> t_children)
           : AST_Node_Impl<T>(std::move(t_ast_node_text), AST_Node_Type::Prefix, std::move(t_loc), std::move(t_children))
-          , m_oper(Operators::to_operator(this->text, true)) {
+          , m_oper(Operators::to_operator(this->text, true))
+          , m_name(this->text) {
       }
 
       Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
@@ -1174,8 +1994,9 @@ namespace chaiscript {
             return Boxed_Number::do_oper(m_oper, bv);
           } else {
             chaiscript::eval::detail::Function_Push_Pop fpp(t_ss);
-            fpp.save_params(Function_Params{bv});
-            return t_ss->call_function(this->text, m_loc, Function_Params{bv}, t_ss.conversions());
+            auto retval = t_ss->call_function(m_name, m_loc, Function_Params{bv}, t_ss.conversions());
+            fpp.save_params(Function_Params{bv}, retval);
+            return retval;
           }
         } catch (const exception::dispatch_error &e) {
           throw exception::eval_error("Error with prefix operator evaluation: '" + this->text + "'", e.parameters, e.functions, false, *t_ss);
@@ -1184,6 +2005,7 @@ namespace chaiscript {
 
     private:
       Operators::Opers m_oper = Operators::Opers::invalid;
+      utility::Interned_String m_name;
       mutable std::atomic_uint_fast32_t m_loc = {0};
     };
 
@@ -1239,11 +2061,32 @@ namespace chaiscript {
           : AST_Node_Impl<T>(std::move(t_ast_node_text), AST_Node_Type::Inline_Range, std::move(t_loc), std::move(t_children)) {
       }
 
+      /// What evaluates this range, set by optimizer::Lazy_Range. A ranged `for` and the prelude's algorithms walk it
+      /// once from the front, so for integral bounds they get a dispatch::Integral_Range instead of a Vector. An
+      /// algorithm only does when every overload of m_callee the range could be passed to walks it that way, see
+      /// walks_ranges_once.
+      enum class Consumer {
+        Any,
+        Loop,
+        Algorithm
+      };
+
+      Consumer m_consumer = Consumer::Any;
+      /// the algorithm a Consumer::Algorithm range is the first argument of, and how many arguments it is called with
+      std::string m_callee;
+      int m_num_args = 0;
+
       Boxed_Value eval_internal(const chaiscript::detail::Dispatch_State &t_ss) const override {
         try {
           std::array<Boxed_Value, 2> params{this->children[0]->children[0]->children[0]->eval(t_ss),
                                             this->children[0]->children[0]->children[1]->eval(t_ss)};
 
+          if (m_consumer == Consumer::Loop || (m_consumer == Consumer::Algorithm && walks_ranges_once(t_ss))) {
+            if (auto range = dispatch::Integral_Range::from_bounds(params[0], params[1])) {
+              return Boxed_Value(std::move(*range), true);
+            }
+          }
+
           return t_ss->call_function("generate_range", m_loc, Function_Params{params}, t_ss.conversions());
         } catch (const exception::dispatch_error &e) {
           throw exception::eval_error("Unable to generate range vector, while calling 'generate_range'", e.parameters, e.functions, false, *t_ss);
@@ -1251,7 +2094,61 @@ namespace chaiscript {
       }
 
     private:
+      struct Algorithm_Cache {
+        const chaiscript::detail::Dispatch_Engine *engine = nullptr;
+        uint_fast32_t generation = 0;
+        bool walks_once = false;
+      };
+
+      /// True if the engine has Integral_Range registered, as the standard library does, and every overload of m_callee
+      /// that an Integral_Range could be passed to either takes one natively or is a library function of the prelude,
+      /// see Dispatch_Engine::is_library_function. Any other overload, such as a script's function of the same name,
+      /// may keep or change its argument, so it gets a Vector.
+      bool walks_ranges_once(const chaiscript::detail::Dispatch_State &t_ss) const {
+        auto &cache = *m_algorithm_cache;
+        const auto generation = t_ss->function_generation();
+        if (cache.engine == &*t_ss && cache.generation == generation) {
+          return cache.walks_once;
+        }
+
+        cache.engine = &*t_ss;
+        cache.generation = generation;
+        cache.walks_once = false;
+
+        const auto range_type = user_type<dispatch::Integral_Range>();
+        if (!t_ss->get_type("Integral_Range", false).bare_equal(range_type)) {
+          return false;
+        }
+
+        bool any = false;
+        for (const auto &func : *t_ss->get_function(m_callee, m_callee_loc).second) {
+          if (func->get_arity() != -1 && func->get_arity() != m_num_args) {
+            continue;
+          }
+
+          if (!t_ss->is_library_function(func)) {
+            if (dynamic_cast<const dispatch::Dynamic_Proxy_Function *>(func.get()) != nullptr) {
+              return false;
+            }
+
+            const auto &types = func->get_param_types();
+            if (types.size() < 2 || types[1].is_undef() || types[1].bare_equal(user_type<Boxed_Value>())) {
+              return false;
+            } else if (!types[1].bare_equal(range_type)) {
+              // takes some other type, which the range is never converted to
+              continue;
+            }
+          }
+          any = true;
+        }
+
+        cache.walks_once = any;
+        return any;
+      }
+
       mutable std::atomic_uint_fast32_t m_loc = {0};
+      mutable std::atomic_uint_fast32_t m_callee_loc = {0};
+      mutable chaiscript::detail::threading::Thread_Storage<Algorithm_Cache> m_algorithm_cache;
     };
 
     template<typename T>
@@ -7,6 +7,14 @@
 #ifndef CHAISCRIPT_OPTIMIZER_HPP_
 #define CHAISCRIPT_OPTIMIZER_HPP_
 
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <typeinfo>
+#include <utility>
+
 #include "chaiscript_eval.hpp"
 
 namespace chaiscript {
@@ -168,10 +176,7 @@ namespace chaiscript {
           for (size_t i = 0; i < node->children.size() - 1; ++i) {
             auto child = node->children[i].get();
             if (child->identifier == AST_Node_Type::Fun_Call) {
-              node->children[i]
-                  = chaiscript::make_unique<eval::AST_Node_Impl<T>, eval::Unused_Return_Fun_Call_AST_Node<T>>(child->text,
-                                                                                                              child->location,
-                                                                                                              std::move(child->children));
+              node->children[i] = unused_return_call(*child);
             }
           }
         } else if ((node->identifier == AST_Node_Type::For || node->identifier == AST_Node_Type::While) && child_count(*node) > 0) {
@@ -181,14 +186,170 @@ namespace chaiscript {
             for (size_t i = 0; i < num_sub_children; ++i) {
               auto &sub_child = child_at(child, i);
               if (sub_child.identifier == AST_Node_Type::Fun_Call) {
-                child.children[i] = chaiscript::make_unique<eval::AST_Node_Impl<T>, eval::Unused_Return_Fun_Call_AST_Node<T>>(
-                    sub_child.text, sub_child.location, std::move(sub_child.children));
+                child.children[i] = unused_return_call(sub_child);
               }
             }
           }
         }
         return node;
       }
+
+    private:
+      template<typename T>
+      static eval::AST_Node_Impl_Ptr<T> unused_return_call(eval::AST_Node_Impl<T> &call) {
+        if (dynamic_cast<const eval::Inline_Fun_Call_AST_Node<T, true> *>(&call)) {
+          return chaiscript::make_unique<eval::AST_Node_Impl<T>, eval::Inline_Fun_Call_AST_Node<T, false>>(call.text,
+                                                                                                           call.location,
+                                                                                                           std::move(call.children));
+        } else {
+          return chaiscript::make_unique<eval::AST_Node_Impl<T>, eval::Unused_Return_Fun_Call_AST_Node<T>>(call.text,
+                                                                                                          call.location,
+                                                                                                          std::move(call.children));
+        }
+      }
+    };
+
+    /// Turns calls of named functions with few enough arguments into eval::Inline_Fun_Call_AST_Node,
+    /// which decides at runtime whether the function they resolve to can be inlined
+    struct Inline {
+      template<typename T>
+      auto optimize(eval::AST_Node_Impl_Ptr<T> node) {
+        if (node->identifier == AST_Node_Type::Fun_Call && node->children.size() == 2
+            && node->children[0]->identifier == AST_Node_Type::Id && node->children[1]->identifier == AST_Node_Type::Arg_List
+            && node->children[1]->children.size() <= dispatch::detail::max_stack_params
+            && typeid(std::as_const(*node)) == typeid(eval::Fun_Call_AST_Node<T>)) {
+          return chaiscript::make_unique<eval::AST_Node_Impl<T>, eval::Inline_Fun_Call_AST_Node<T, true>>(node->text,
+                                                                                                          node->location,
+                                                                                                          std::move(node->children));
+        }
+
+        return node;
+      }
+    };
+
+    /// Turns calls of named functions whose arguments are all constants into eval::Fold_Fun_Call_AST_Node,
+    /// which keeps the result once it has seen that the function called is pure. What a name refers to is
+    /// only known when the script runs, so the call is folded on its first evaluation rather than here.
+    struct Fold_Pure_Call {
+      template<typename T>
+      auto optimize(eval::AST_Node_Impl_Ptr<T> node) {
+        if (node->identifier == AST_Node_Type::Fun_Call && node->children.size() == 2
+            && node->children[0]->identifier == AST_Node_Type::Id && node->children[1]->identifier == AST_Node_Type::Arg_List
+            && std::all_of(node->children[1]->children.begin(),
+                           node->children[1]->children.end(),
+                           [](const auto &arg) { return arg->identifier == AST_Node_Type::Constant; })
+            && typeid(std::as_const(*node)) == typeid(eval::Fun_Call_AST_Node<T>)) {
+          return chaiscript::make_unique<eval::AST_Node_Impl<T>, eval::Fold_Fun_Call_AST_Node<T>>(node->text,
+                                                                                                  node->location,
+                                                                                                  std::move(node->children));
+        }
+
+        return node;
+      }
+    };
+
+    /// Makes `def`s run the calls of themselves they end in as a loop, see eval::Tail_Fun_Call_AST_Node.
+    ///
+    /// A node is in tail position if the function returns its value without doing anything else: the body,
+    /// the last statement of a block in tail position, both branches of an `if` or `?:` in tail position, and
+    /// the value of any `return` that is not inside a `try`. A `return` in tail position is replaced by its
+    /// value, which saves throwing it, and a call of the function by its own name in tail position becomes a
+    /// tail call.
+    struct Tail_Call {
+      template<typename T>
+      auto optimize(eval::AST_Node_Impl_Ptr<T> node) {
+        if (node->identifier == AST_Node_Type::Def) {
+          auto &def = dynamic_cast<eval::Def_AST_Node<T> &>(*node);
+          while (def.m_body_node->identifier == AST_Node_Type::Return && def.m_body_node->children.size() == 1) {
+            def.m_body_node = std::move(def.m_body_node->children[0]);
+          }
+
+          auto [begin, end] = tail_children(*def.m_body_node);
+          for (; begin != end; ++begin) {
+            mark_tail_calls(*begin, def.children[0]->text, *def.m_body_node);
+          }
+          mark_returned_tail_calls(*def.m_body_node, def.children[0]->text, *def.m_body_node);
+        }
+
+        return node;
+      }
+
+    private:
+      /// Marks the tail calls in the value of every `return` below t_node, except those inside a `try`, whose
+      /// catch blocks must still see the exceptions of the call, or inside a nested function
+      template<typename T>
+      static void mark_returned_tail_calls(eval::AST_Node_Impl<T> &t_node, const std::string &t_name, const eval::AST_Node_Impl<T> &t_body) {
+        for (auto &child : t_node.children) {
+          switch (child->identifier) {
+            case AST_Node_Type::Try:
+            case AST_Node_Type::Def:
+            case AST_Node_Type::Lambda:
+            case AST_Node_Type::Method:
+            case AST_Node_Type::Class:
+              break;
+            case AST_Node_Type::Return:
+              if (child->children.size() == 1) {
+                mark_tail_calls(child->children[0], t_name, t_body);
+              }
+              break;
+            case AST_Node_Type::Compiled:
+              mark_returned_tail_calls(*dynamic_cast<eval::Compiled_AST_Node<T> &>(*child).m_original_node, t_name, t_body);
+              mark_returned_tail_calls(*child, t_name, t_body);
+              break;
+            default:
+              mark_returned_tail_calls(*child, t_name, t_body);
+          }
+        }
+      }
+
+      /// The children of t_node in tail position when t_node is, or t_node's children past the end if none are
+      template<typename T>
+      static auto tail_children(eval::AST_Node_Impl<T> &t_node) {
+        auto &children = t_node.children;
+        switch (t_node.identifier) {
+          case AST_Node_Type::Block:
+          case AST_Node_Type::Scopeless_Block:
+            return std::make_pair(children.empty() ? children.end() : std::prev(children.end()), children.end());
+          case AST_Node_Type::If:
+            return std::make_pair(children.size() == 3 ? std::next(children.begin()) : children.end(), children.end());
+          default:
+            return std::make_pair(children.end(), children.end());
+        }
+      }
+
+      template<typename T>
+      static bool is_self_call(const eval::AST_Node_Impl<T> &t_node, const std::string &t_name) {
+        return t_node.identifier == AST_Node_Type::Fun_Call && t_node.children.size() == 2
+            && t_node.children[0]->identifier == AST_Node_Type::Id && t_node.children[0]->text == t_name
+            && t_node.children[1]->identifier == AST_Node_Type::Arg_List;
+      }
+
+      template<typename T>
+      static void mark_tail_calls(eval::AST_Node_Impl_Ptr<T> &t_node, const std::string &t_name, const eval::AST_Node_Impl<T> &t_body) {
+        while (t_node->identifier == AST_Node_Type::Return && t_node->children.size() == 1) {
+          t_node = std::move(t_node->children[0]);
+        }
+
+        if (t_node->identifier == AST_Node_Type::Compiled) {
+          // a call Loop_Invariant would keep the value of, which the tail call replaces
+          auto &original = dynamic_cast<eval::Compiled_AST_Node<T> &>(*t_node).m_original_node;
+          if (is_self_call(*original, t_name)) {
+            t_node = std::move(original);
+          }
+        }
+
+        if (is_self_call(*t_node, t_name)) {
+          t_node = chaiscript::make_unique<eval::AST_Node_Impl<T>, eval::Tail_Fun_Call_AST_Node<T>>(t_node->text,
+                                                                                                   t_node->location,
+                                                                                                   std::move(t_node->children),
+                                                                                                   t_body);
+        } else {
+          auto [begin, end] = tail_children(*t_node);
+          for (; begin != end; ++begin) {
+            mark_tail_calls(*begin, t_name, t_body);
+          }
+        }
+      }
     };
 
     struct Assign_Decl {
@@ -226,6 +387,129 @@ namespace chaiscript {
       }
     };
 
+    /// Turns a `switch` whose case labels are all int constants or all string constants into
+    /// eval::Table_Switch_AST_Node, which jumps to the matching case instead of comparing the labels in turn
+    struct Switch {
+      template<typename T>
+      auto optimize(eval::AST_Node_Impl_Ptr<T> node) {
+        if (node->identifier == AST_Node_Type::Switch && typeid(std::as_const(*node)) == typeid(eval::Switch_AST_Node<T>)
+            && (has_labels_of<T, int>(*node) || has_labels_of<T, std::string>(*node))) {
+          return chaiscript::make_unique<eval::AST_Node_Impl<T>, eval::Table_Switch_AST_Node<T>>(node->text,
+                                                                                                 node->location,
+                                                                                                 std::move(node->children));
+        }
+
+        return node;
+      }
+
+    private:
+      /// True if t_switch has a case and the labels of all its cases are constants of type Label
+      template<typename T, typename Label>
+      static bool has_labels_of(const eval::AST_Node_Impl<T> &t_switch) {
+        bool has_case = false;
+        for (size_t i = 1; i < t_switch.children.size(); ++i) {
+          const auto &child = *t_switch.children[i];
+          if (child.identifier == AST_Node_Type::Case) {
+            if (child.children[0]->identifier != AST_Node_Type::Constant
+                || !dynamic_cast<const eval::Constant_AST_Node<T> &>(*child.children[0]).m_value.get_type_info().bare_equal_type_info(typeid(Label))) {
+              return false;
+            }
+            has_case = true;
+          } else if (child.identifier != AST_Node_Type::Default) {
+            return false;
+          }
+        }
+        return has_case;
+      }
+    };
+
+    /// Lets a range literal `[a..b]` that is walked once and then dropped evaluate lazily, see
+    /// eval::Inline_Range_AST_Node::Consumer: the range of a ranged `for`, and the first argument of a call of
+    /// one of the prelude's algorithms, by name or as a method. Anywhere else it still makes a Vector. Which
+    /// function such a call reaches is only known when it runs, so the range checks that again then.
+    struct Lazy_Range {
+      template<typename T>
+      auto optimize(eval::AST_Node_Impl_Ptr<T> node) {
+        using Consumer = typename eval::Inline_Range_AST_Node<T>::Consumer;
+
+        if (node->identifier == AST_Node_Type::Ranged_For && node->children.size() == 3) {
+          mark(*node->children[1], Consumer::Loop);
+        } else if (node->identifier == AST_Node_Type::Fun_Call && node->children.size() == 2
+                   && node->children[0]->identifier == AST_Node_Type::Id && is_algorithm(node->children[0]->text)
+                   && !node->children[1]->children.empty()) {
+          mark(*node->children[1]->children[0], Consumer::Algorithm, node->children[0]->text, node->children[1]->children.size());
+        } else if (node->identifier == AST_Node_Type::Dot_Access && node->children.size() == 2
+                   && node->children[1]->identifier == AST_Node_Type::Fun_Call && node->children[1]->children.size() == 2
+                   && is_algorithm(node->children[1]->children[0]->text)) {
+          mark(*node->children[0], Consumer::Algorithm, node->children[1]->children[0]->text, node->children[1]->children[1]->children.size() + 1);
+        }
+
+        return node;
+      }
+
+    private:
+      template<typename T>
+      static void mark(eval::AST_Node_Impl<T> &t_node,
+                       typename eval::Inline_Range_AST_Node<T>::Consumer t_consumer,
+                       const std::string &t_callee = std::string(),
+                       const std::size_t t_num_args = 0) {
+        if (t_node.identifier == AST_Node_Type::Inline_Range) {
+          auto &range = dynamic_cast<eval::Inline_Range_AST_Node<T> &>(t_node);
+          range.m_consumer = t_consumer;
+          range.m_callee = t_callee;
+          range.m_num_args = static_cast<int>(t_num_args);
+        }
+      }
+
+      /// True for the prelude's functions that only walk their first argument with `range` and make results with `new`
+      static bool is_algorithm(const std::string &t_name) noexcept {
+        static constexpr std::string_view algorithms[] = {"all_of", "any_of", "contains", "drop", "drop_while", "filter", "foldl", "for_each",
+                                                          "join", "map", "product", "reduce", "sum", "take", "take_while"};
+        return std::find(std::begin(algorithms), std::end(algorithms), t_name) != std::end(algorithms);
+      }
+    };
+
+    /// Turns a `Hash_Map(...)` call of a map literal into eval::Hash_Map_Call_AST_Node, which lets the literal build
+    /// the Hash_Map itself when the call would only convert it
+    struct Hash_Map_Literal {
+      template<typename T>
+      auto optimize(eval::AST_Node_Impl_Ptr<T> node) {
+        if (node->identifier == AST_Node_Type::Fun_Call && node->children.size() == 2 && node->children[0]->identifier == AST_Node_Type::Id
+            && node->children[0]->text == "Hash_Map" && node->children[1]->children.size() == 1
+            && node->children[1]->children[0]->identifier == AST_Node_Type::Inline_Map
+            && typeid(std::as_const(*node)) == typeid(eval::Fun_Call_AST_Node<T>)) {
+          return chaiscript::make_unique<eval::AST_Node_Impl<T>, eval::Hash_Map_Call_AST_Node<T>>(node->text,
+                                                                                                  node->location,
+                                                                                                  std::move(node->children));
+        }
+
+        return node;
+      }
+    };
+
+    /// Marks `x = x + a + b ...`, the variable assigned to being the left end of the sum, to append to x in place
+    /// when it is a string, see eval::Equation_AST_Node::m_appends
+    struct Append_Assign {
+      template<typename T>
+      auto optimize(eval::AST_Node_Impl_Ptr<T> node) {
+        if (node->identifier == AST_Node_Type::Equation && node->text == "=" && node->children.size() == 2
+            && node->children[0]->identifier == AST_Node_Type::Id && node->children[1]->identifier == AST_Node_Type::Binary
+            && node->children[1]->text == "+") {
+          const auto *left_end = node->children[1].get();
+          while (left_end->identifier == AST_Node_Type::Binary && left_end->text == "+" && left_end->children.size() == 2) {
+            left_end = left_end->children[0].get();
+          }
+
+          auto *equation = dynamic_cast<eval::Equation_AST_Node<T> *>(node.get());
+          if (equation != nullptr && left_end->identifier == AST_Node_Type::Id && left_end->text == node->children[0]->text) {
+            equation->m_appends = true;
+          }
+        }
+
+        return node;
+      }
+    };
+
     struct Partial_Fold {
       template<typename T>
       auto optimize(eval::AST_Node_Impl_Ptr<T> node) {
@@ -348,72 +632,953 @@ namespace chaiscript {
       }
     };
 
+    /// Compiles counted loops, `for (var i = <init>; i <op> <bound>; <step>)`, into a native loop
+    /// over the integral type <init> evaluates to.
+    ///
+    /// <op> is any of `<`, `<=`, `>`, `>=` and `!=`, and <step> is `++i`, `--i`, `i += <constant>` or
+    /// `i -= <constant>`. The counter keeps the type of its initial value. How often the bound is
+    /// evaluated depends on what it is:
+    ///  - a constant, or an expression proven to be loop invariant, is evaluated once;
+    ///  - a plain variable is looked up once and its current value is read on every test;
+    ///  - anything else is evaluated on every test, as before.
+    ///
+    /// Whenever the counter or the bound do not have the types the loop was specialized on, that
+    /// iteration falls back to the semantics of the original condition and step expressions.
     struct For_Loop {
+      enum class Bound_Kind {
+        constant,
+        variable,
+        invariant,
+        evaluated
+      };
+
+      struct Loop_Info {
+        std::string id;
+        std::string oper_text;
+        Operators::Opers oper = Operators::Opers::invalid;
+        Bound_Kind bound_kind = Bound_Kind::evaluated;
+
+        /// For Bound_Kind::invariant: objects read by the bound, names written by the body,
+        /// names the body declares itself and the functions / operators either of them dispatch to
+        std::vector<std::string> bound_ids;
+        std::vector<std::string> written_ids;
+        std::vector<std::string> declared_ids;
+        std::vector<std::string> functions;
+
+        mutable std::atomic_uint_fast32_t loc = {0};
+      };
+
       template<typename T>
       auto optimize(eval::AST_Node_Impl_Ptr<T> for_node) {
-        if (for_node->identifier != AST_Node_Type::For) {
+        if (for_node->identifier != AST_Node_Type::For || child_count(*for_node) != 4) {
           return for_node;
         }
 
-        const auto &eq_node = child_at(*for_node, 0);
-        const auto &binary_node = child_at(*for_node, 1);
-        const auto &prefix_node = child_at(*for_node, 2);
-
-        if (child_count(*for_node) == 4 && eq_node.identifier == AST_Node_Type::Assign_Decl && child_count(eq_node) == 2
-            && child_at(eq_node, 0).identifier == AST_Node_Type::Id && child_at(eq_node, 1).identifier == AST_Node_Type::Constant
-            && binary_node.identifier == AST_Node_Type::Binary && binary_node.text == "<" && child_count(binary_node) == 2
-            && child_at(binary_node, 0).identifier == AST_Node_Type::Id && child_at(binary_node, 0).text == child_at(eq_node, 0).text
-            && child_at(binary_node, 1).identifier == AST_Node_Type::Constant && prefix_node.identifier == AST_Node_Type::Prefix
-            && prefix_node.text == "++" && child_count(prefix_node) == 1 && child_at(prefix_node, 0).identifier == AST_Node_Type::Id
-            && child_at(prefix_node, 0).text == child_at(eq_node, 0).text) {
-          const Boxed_Value &begin = dynamic_cast<const eval::Constant_AST_Node<T> &>(child_at(eq_node, 1)).m_value;
-          const Boxed_Value &end = dynamic_cast<const eval::Constant_AST_Node<T> &>(child_at(binary_node, 1)).m_value;
-          const std::string &id = child_at(prefix_node, 0).text;
-
-          if (begin.get_type_info().bare_equal(user_type<int>()) && end.get_type_info().bare_equal(user_type<int>())) {
-            const auto start_int = boxed_cast<int>(begin);
-            const auto end_int = boxed_cast<int>(end);
-
-            // note that we are moving the last element out, then popping the empty shared_ptr
-            // from the vector
-            std::vector<eval::AST_Node_Impl_Ptr<T>> body_vector;
-            auto body_child = std::move(for_node->children[3]);
-            for_node->children.pop_back();
-            body_vector.emplace_back(std::move(body_child));
-
-            return make_compiled_node(std::move(for_node),
-                                      std::move(body_vector),
-                                      [id, start_int, end_int](const std::vector<eval::AST_Node_Impl_Ptr<T>> &children,
-                                                               const chaiscript::detail::Dispatch_State &t_ss) {
-                                        assert(children.size() == 1);
-                                        chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
-
-                                        int i = start_int;
-                                        t_ss.add_object(id, var(&i));
-
-                                        try {
-                                          for (; i < end_int; ++i) {
-                                            try {
-                                              // Body of Loop
-                                              children[0]->eval(t_ss);
-                                            } catch (eval::detail::Continue_Loop &) {
-                                              // we got a continue exception, which means all of the remaining
-                                              // loop implementation is skipped and we just need to continue to
-                                              // the next iteration step
-                                            }
-                                          }
-                                        } catch (eval::detail::Break_Loop &) {
-                                          // loop broken
-                                        }
-
-                                        return void_var();
-                                      });
+        const auto &init_node = child_at(*for_node, 0);
+        const auto &condition_node = child_at(*for_node, 1);
+        const auto &step_node = child_at(*for_node, 2);
+
+        if (init_node.identifier != AST_Node_Type::Assign_Decl || child_count(init_node) != 2
+            || child_at(init_node, 0).identifier != AST_Node_Type::Id) {
+          return for_node;
+        }
+
+        auto info = std::make_shared<Loop_Info>();
+        info->id = child_at(init_node, 0).text;
+        info->oper_text = condition_node.text;
+        info->oper = Operators::to_operator(condition_node.text);
+
+        if (condition_node.identifier != AST_Node_Type::Binary || child_count(condition_node) != 2
+            || child_at(condition_node, 0).identifier != AST_Node_Type::Id || child_at(condition_node, 0).text != info->id
+            || (info->oper != Operators::Opers::less_than && info->oper != Operators::Opers::less_than_equal
+                && info->oper != Operators::Opers::greater_than && info->oper != Operators::Opers::greater_than_equal
+                && info->oper != Operators::Opers::not_equal)) {
+          return for_node;
+        }
+
+        // the step, as an increment or decrement by a constant
+        bool decrement = false;
+        Boxed_Value step;
+        if (step_node.identifier == AST_Node_Type::Prefix && (step_node.text == "++" || step_node.text == "--") && child_count(step_node) == 1
+            && child_at(step_node, 0).identifier == AST_Node_Type::Id && child_at(step_node, 0).text == info->id) {
+          decrement = step_node.text == "--";
+          step = Boxed_Value(1);
+        } else if (step_node.identifier == AST_Node_Type::Equation && (step_node.text == "+=" || step_node.text == "-=")
+                   && child_count(step_node) == 2 && child_at(step_node, 0).identifier == AST_Node_Type::Id
+                   && child_at(step_node, 0).text == info->id && child_at(step_node, 1).identifier == AST_Node_Type::Constant) {
+          decrement = step_node.text == "-=";
+          step = dynamic_cast<const eval::Constant_AST_Node<T> &>(child_at(step_node, 1)).m_value;
+        } else {
+          return for_node;
+        }
+
+        if (!step.get_type_info().is_arithmetic() || Boxed_Number::is_floating_point(step)) {
+          return for_node;
+        }
+
+        const auto &bound_node = child_at(condition_node, 1);
+        if (bound_node.identifier == AST_Node_Type::Constant) {
+          info->bound_kind = Bound_Kind::constant;
+        } else if (bound_node.identifier == AST_Node_Type::Id && bound_node.text != info->id) {
+          info->bound_kind = Bound_Kind::variable;
+        } else if (scan_invariant_bound(bound_node, *info) && scan_invariant_body(child_at(*for_node, 3), *info)) {
+          info->bound_kind = Bound_Kind::invariant;
+          info->functions.emplace_back("clone");
+        } else {
+          info->bound_kind = Bound_Kind::evaluated;
+        }
+
+        if (child_at(init_node, 1).identifier == AST_Node_Type::Constant
+            && !is_counter_type(dynamic_cast<const eval::Constant_AST_Node<T> &>(child_at(init_node, 1)).m_value.get_type_info())) {
+          return for_node;
+        }
+
+        // note that we are moving all of the children out, the original node is only kept around for reference
+        auto loop_children = std::move(for_node->children);
+        for_node->children.clear();
+
+        return make_compiled_node(std::move(for_node),
+                                  std::move(loop_children),
+                                  [info, step, decrement](const std::vector<eval::AST_Node_Impl_Ptr<T>> &children,
+                                                          const chaiscript::detail::Dispatch_State &t_ss) {
+                                    assert(children.size() == 4);
+                                    return run<T>(*info, step, decrement, children, t_ss);
+                                  });
+      }
+
+    private:
+      /// A bound is a candidate for hoisting if it is built from constants, variables and
+      /// `x.size()` / `size(x)` with arithmetic operators
+      template<typename T>
+      static bool scan_invariant_bound(const eval::AST_Node_Impl<T> &node, Loop_Info &info) {
+        if (node.identifier == AST_Node_Type::Constant) {
+          return true;
+        } else if (node.identifier == AST_Node_Type::Id) {
+          if (node.text == info.id) {
+            return false;
+          }
+          info.bound_ids.push_back(node.text);
+          return true;
+        } else if (node.identifier == AST_Node_Type::Binary && child_count(node) == 2
+                   && (node.text == "+" || node.text == "-" || node.text == "*" || node.text == "/")) {
+          info.functions.push_back(node.text);
+          return scan_invariant_bound(child_at(node, 0), info) && scan_invariant_bound(child_at(node, 1), info);
+        }
+
+        const eval::AST_Node_Impl<T> *object = nullptr;
+        if (node.identifier == AST_Node_Type::Dot_Access && child_count(node) == 2 && child_at(node, 1).identifier == AST_Node_Type::Fun_Call) {
+          // x.size()
+          const auto &call = child_at(node, 1);
+          if (child_count(call) == 2 && child_at(call, 0).text == "size" && child_count(child_at(call, 1)) == 0) {
+            object = &child_at(node, 0);
+          }
+        } else if (node.identifier == AST_Node_Type::Fun_Call && child_count(node) == 2 && child_at(node, 0).identifier == AST_Node_Type::Id
+                   && child_at(node, 0).text == "size" && child_count(child_at(node, 1)) == 1) {
+          // size(x)
+          object = &child_at(child_at(node, 1), 0);
+        }
+
+        if (object && object->identifier == AST_Node_Type::Id && object->text != info.id) {
+          info.functions.emplace_back("size");
+          info.bound_ids.push_back(object->text);
+          return true;
+        }
+
+        return false;
+      }
+
+      /// The body may only contain constructs that cannot reach the bound except through the
+      /// variables it assigns to, and only assign to plain variables; run() checks those at runtime.
+      template<typename T>
+      static bool scan_invariant_body(const eval::AST_Node_Impl<T> &node, Loop_Info &info) {
+        switch (node.identifier) {
+          case AST_Node_Type::Id:
+          case AST_Node_Type::Constant:
+          case AST_Node_Type::Block:
+          case AST_Node_Type::Scopeless_Block:
+          case AST_Node_Type::While:
+          case AST_Node_Type::If:
+          case AST_Node_Type::For:
+          case AST_Node_Type::Break:
+          case AST_Node_Type::Continue:
+          case AST_Node_Type::Return:
+          case AST_Node_Type::Logical_And:
+          case AST_Node_Type::Logical_Or:
+          case AST_Node_Type::Default:
+          case AST_Node_Type::Noop:
+            break;
+          case AST_Node_Type::Assign_Decl:
+            info.declared_ids.push_back(child_at(node, 0).text);
+            break;
+          case AST_Node_Type::Binary:
+          case AST_Node_Type::Prefix:
+            info.functions.push_back(node.text);
+            if (node.text == "++" || node.text == "--") {
+              if (child_at(node, 0).identifier != AST_Node_Type::Id) {
+                return false;
+              }
+              info.written_ids.push_back(child_at(node, 0).text);
+            }
+            break;
+          case AST_Node_Type::Equation:
+            if (node.text == ":=" || child_at(node, 0).identifier != AST_Node_Type::Id) {
+              return false;
+            }
+            info.functions.push_back(node.text);
+            info.written_ids.push_back(child_at(node, 0).text);
+            break;
+          case AST_Node_Type::Array_Call:
+            info.functions.emplace_back("[]");
+            break;
+          case AST_Node_Type::Switch:
+          case AST_Node_Type::Case:
+            info.functions.emplace_back("==");
+            break;
+          case AST_Node_Type::Compiled:
+            if (!scan_invariant_body(*dynamic_cast<const eval::Compiled_AST_Node<T> &>(node).m_original_node, info)) {
+              return false;
+            }
+            break;
+          default:
+            return false;
+        }
+
+        for (const auto &child : node.children) {
+          if (!scan_invariant_body(*child, info)) {
+            return false;
+          }
+        }
+
+        return true;
+      }
+
+      /// Runtime half of the invariance proof: no function the loop may dispatch to is script defined,
+      /// and every variable the body writes to is a number that is not one of the bound's objects
+      static bool bound_is_invariant(const Loop_Info &info, const chaiscript::detail::Dispatch_State &t_ss) {
+        for (const auto &name : info.functions) {
+          for (const auto &func : *t_ss->get_function(name, 0).second) {
+            const auto *f = func.get();
+            if (!dynamic_cast<const dispatch::Proxy_Function_Impl_Base *>(f) || dynamic_cast<const dispatch::Assignable_Proxy_Function *>(f)) {
+              return false;
+            }
+          }
+        }
+
+        const auto find_object = [&t_ss](const std::string &name) -> std::optional<Boxed_Value> {
+          try {
+            std::atomic_uint_fast32_t loc{0};
+            return t_ss.get_object(name, loc);
+          } catch (const std::exception &) {
+            return std::nullopt;
+          }
+        };
+
+        std::vector<const void *> bound_objects;
+        for (const auto &name : info.bound_ids) {
+          const auto object = find_object(name);
+          if (!object) {
+            return false;
+          }
+          bound_objects.push_back(object->get_const_ptr());
+        }
+
+        for (const auto &name : info.written_ids) {
+          if (const auto object = find_object(name)) {
+            if (!object->get_type_info().is_arithmetic()
+                || std::find(bound_objects.begin(), bound_objects.end(), object->get_const_ptr()) != bound_objects.end()) {
+              return false;
+            }
+          } else if (std::find(info.declared_ids.begin(), info.declared_ids.end(), name) == info.declared_ids.end()) {
+            return false;
+          }
+        }
+
+        return true;
+      }
+
+      template<typename T>
+      static Boxed_Value eval_bound(const eval::AST_Node_Impl<T> &node, const chaiscript::detail::Dispatch_State &t_ss) {
+        chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
+        return node.eval(t_ss);
+      }
+
+      /// Equivalent of evaluating the original condition, for when the types are not the specialized ones
+      template<typename T>
+      static bool test_boxed(const Loop_Info &info, const Boxed_Value &t_counter, const Boxed_Value &t_bound, const chaiscript::detail::Dispatch_State &t_ss) {
+        try {
+          if (t_counter.get_type_info().is_arithmetic() && t_bound.get_type_info().is_arithmetic()) {
+            try {
+              return eval::AST_Node_Impl<T>::get_bool_condition(Boxed_Number::do_oper(info.oper, t_counter, t_bound), t_ss);
+            } catch (const chaiscript::exception::arithmetic_error &) {
+              throw;
+            } catch (...) {
+              throw exception::eval_error("Error with numeric operator calling: " + info.oper_text);
+            }
           } else {
-            return for_node;
+            chaiscript::eval::detail::Function_Push_Pop fpp(t_ss);
+            std::array<Boxed_Value, 2> params{t_counter, t_bound};
+            return eval::AST_Node_Impl<T>::get_bool_condition(t_ss->call_function(info.oper_text, info.loc, Function_Params(params), t_ss.conversions()),
+                                                              t_ss);
           }
+        } catch (const exception::dispatch_error &e) {
+          throw exception::eval_error("Can not find appropriate '" + info.oper_text + "' operator.", e.parameters, e.functions, false, *t_ss);
+        }
+      }
+
+      static bool is_counter_type(const Type_Info &t_type) noexcept {
+        return t_type.bare_equal(user_type<int>()) || t_type.bare_equal(user_type<unsigned int>()) || t_type.bare_equal(user_type<long>())
+            || t_type.bare_equal(user_type<unsigned long>()) || t_type.bare_equal(user_type<long long>())
+            || t_type.bare_equal(user_type<unsigned long long>());
+      }
+
+      template<typename T>
+      static Boxed_Value run(const Loop_Info &info,
+                             const Boxed_Value &step,
+                             const bool decrement,
+                             const std::vector<eval::AST_Node_Impl_Ptr<T>> &children,
+                             const chaiscript::detail::Dispatch_State &t_ss) {
+        chaiscript::eval::detail::Scope_Push_Pop spp(t_ss);
+
+        const Boxed_Value counter = children[0]->eval(t_ss);
+
+        const auto &counter_type = counter.get_type_info();
+        if (counter_type.bare_equal(user_type<int>())) {
+          return run<T, int>(info, counter, step, decrement, children, t_ss);
+        } else if (counter_type.bare_equal(user_type<unsigned int>())) {
+          return run<T, unsigned int>(info, counter, step, decrement, children, t_ss);
+        } else if (counter_type.bare_equal(user_type<long>())) {
+          return run<T, long>(info, counter, step, decrement, children, t_ss);
+        } else if (counter_type.bare_equal(user_type<unsigned long>())) {
+          return run<T, unsigned long>(info, counter, step, decrement, children, t_ss);
+        } else if (counter_type.bare_equal(user_type<long long>())) {
+          return run<T, long long>(info, counter, step, decrement, children, t_ss);
+        } else if (counter_type.bare_equal(user_type<unsigned long long>())) {
+          return run<T, unsigned long long>(info, counter, step, decrement, children, t_ss);
         } else {
-          return for_node;
+          // not an integral counter, every test and step goes through the original expressions
+          return run<T, int>(info, counter, step, decrement, children, t_ss);
+        }
+      }
+
+      template<typename T, typename Counter>
+      static Boxed_Value run(const Loop_Info &info,
+                             const Boxed_Value &counter,
+                             const Boxed_Value &step,
+                             const bool decrement,
+                             const std::vector<eval::AST_Node_Impl_Ptr<T>> &children,
+                             const chaiscript::detail::Dispatch_State &t_ss) {
+        const auto step_value = Boxed_Number(step).get_as<Counter>();
+
+        const auto &bound_node = *children[1]->children[1];
+        Boxed_Value bound = eval_bound(bound_node, t_ss);
+        const bool reevaluate = info.bound_kind == Bound_Kind::evaluated
+                             || (info.bound_kind == Bound_Kind::invariant && !bound_is_invariant(info, t_ss));
+
+        const auto &bound_type = bound.get_type_info();
+        if (bound_type.bare_equal(user_type<int>())) {
+          return loop<T, Counter, int>(info, counter, bound, step_value, decrement, reevaluate, children, t_ss);
+        } else if (bound_type.bare_equal(user_type<unsigned int>())) {
+          return loop<T, Counter, unsigned int>(info, counter, bound, step_value, decrement, reevaluate, children, t_ss);
+        } else if (bound_type.bare_equal(user_type<long>())) {
+          return loop<T, Counter, long>(info, counter, bound, step_value, decrement, reevaluate, children, t_ss);
+        } else if (bound_type.bare_equal(user_type<unsigned long>())) {
+          return loop<T, Counter, unsigned long>(info, counter, bound, step_value, decrement, reevaluate, children, t_ss);
+        } else if (bound_type.bare_equal(user_type<long long>())) {
+          return loop<T, Counter, long long>(info, counter, bound, step_value, decrement, reevaluate, children, t_ss);
+        } else if (bound_type.bare_equal(user_type<unsigned long long>())) {
+          return loop<T, Counter, unsigned long long>(info, counter, bound, step_value, decrement, reevaluate, children, t_ss);
+        } else {
+          // not an integral bound, every test goes through test_boxed
+          return loop<T, Counter, Counter>(info, counter, bound, step_value, decrement, reevaluate, children, t_ss);
+        }
+      }
+
+      template<typename T, typename Counter, typename Bound>
+      static Boxed_Value loop(const Loop_Info &info,
+                              const Boxed_Value &counter,
+                              Boxed_Value &bound,
+                              const Counter step,
+                              const bool decrement,
+                              const bool reevaluate,
+                              const std::vector<eval::AST_Node_Impl_Ptr<T>> &children,
+                              const chaiscript::detail::Dispatch_State &t_ss) {
+        constexpr auto counter_type = user_type<Counter>();
+        constexpr auto bound_type = user_type<Bound>();
+
+        try {
+          while (true) {
+            // the body can rebind both the counter and a variable bound (`:=`), so check the types every time
+            const bool native_test = counter.get_type_info().bare_equal(counter_type) && bound.get_type_info().bare_equal(bound_type);
+            if (!(native_test ? Boxed_Number::compare(info.oper,
+                                                      *static_cast<const Counter *>(counter.get_const_ptr()),
+                                                      *static_cast<const Bound *>(bound.get_const_ptr()))
+                              : test_boxed<T>(info, counter, bound, t_ss))) {
+              break;
+            }
+
+            try {
+              // Body of Loop
+              children[3]->eval(t_ss);
+            } catch (eval::detail::Continue_Loop &) {
+              // we got a continue exception, which means all of the remaining
+              // loop implementation is skipped and we just need to continue to
+              // the next iteration step
+            }
+
+            if (counter.get_type_info().bare_equal(counter_type) && !counter.is_const()) {
+              auto &i = *static_cast<Counter *>(counter.get_ptr());
+              if (decrement) {
+                i -= step;
+              } else {
+                i += step;
+              }
+            } else {
+              children[2]->eval(t_ss);
+            }
+
+            if (reevaluate) {
+              bound = eval_bound(*children[1]->children[1], t_ss);
+            }
+          }
+        } catch (eval::detail::Break_Loop &) {
+          // loop broken
+        }
+
+        return void_var();
+      }
+    };
+
+    /// Hoists pure, loop invariant expressions out of `while`, `for` and ranged `for` loops, and lets
+    /// structurally identical ones share a single value (loop-invariant code motion with common
+    /// subexpression elimination).
+    ///
+    /// A candidate is a largest expression in the condition, step or body of a loop that calls at least
+    /// one function and is built only from constants, operators, calls by name and variables the loop
+    /// never assigns to or declares. Whether it may really be reused depends on what its names resolve
+    /// to, so every time the loop starts it checks, per candidate, that
+    ///  - every function the candidate may dispatch to was declared pure, see chaiscript::pure;
+    ///  - the loop cannot call a script defined function, which could reach the candidate's inputs
+    ///    through a global or a captured variable;
+    ///  - no variable the candidate reads is assigned to, or passed to a function that is not pure,
+    ///    under its own name or as the loop variable of a ranged for over it.
+    /// A valid candidate is evaluated the first time the loop reaches it, and later evaluations in the
+    /// same run of the loop return a copy of that value. Only numbers, booleans and strings returned by
+    /// value are reused, anything else is evaluated every time.
+    struct Loop_Invariant {
+      struct Candidate {
+        /// operators and methods, dispatched by name
+        std::vector<std::string> functions;
+        /// names looked up like variables and then called, `f(x)`
+        std::vector<std::string> callees;
+        /// objects methods are called on
+        std::vector<std::string> receivers;
+        std::vector<std::string> ids;
+      };
+
+      enum class Effect_Kind {
+        function,
+        callee,
+        method,
+        attribute
+      };
+
+      /// A call anywhere in the loop, with the variables that are passed to it directly
+      struct Effect {
+        Effect_Kind kind;
+        std::string name;
+        std::string receiver;
+        std::vector<std::string> ids;
+      };
+
+      struct Slot {
+        bool valid = false;
+        bool cached = false;
+        Boxed_Value value;
+      };
+
+      struct Loop_Info {
+        std::vector<Candidate> candidates;
+        std::vector<Effect> effects;
+        std::vector<std::string> written_ids;
+        std::vector<std::string> declared_ids;
+
+        /// loop variables of ranged for loops, which refer into the objects their range expression reads
+        std::vector<std::pair<std::string, std::vector<std::string>>> aliases;
+
+        /// one slot per candidate while the loop runs on this thread, empty otherwise
+        mutable chaiscript::detail::threading::Thread_Storage<std::vector<Slot>> slots;
+      };
+
+      template<typename T>
+      auto optimize(eval::AST_Node_Impl_Ptr<T> node) {
+        // the children holding the condition, step and body; a for loop's initializer runs before the loop
+        std::size_t first = 0;
+        if (node->identifier == AST_Node_Type::While && node->children.size() == 2) {
+          first = 0;
+        } else if (node->identifier == AST_Node_Type::For && node->children.size() == 4) {
+          first = 1;
+        } else if (node->identifier == AST_Node_Type::Compiled && node->children.size() == 4
+                   && dynamic_cast<const eval::Compiled_AST_Node<T> &>(*node).m_original_node->identifier == AST_Node_Type::For) {
+          first = 1;
+        } else if (node->identifier == AST_Node_Type::Ranged_For && node->children.size() == 3) {
+          first = 2;
+        } else {
+          return node;
+        }
+
+        auto info = std::make_shared<Loop_Info>();
+        if (!scan(*node, *info)) {
+          return node;
+        }
+
+        std::vector<std::string> keys;
+        for (auto i = first; i < node->children.size(); ++i) {
+          hoist(node->children[i], info, keys);
+        }
+
+        if (info->candidates.empty()) {
+          return node;
         }
+
+        // the loop itself stays the original node, so other passes still see it as a loop
+        const auto *loop = node.get();
+        return make_compiled_node(std::move(node),
+                                  {},
+                                  [info, loop](const std::vector<eval::AST_Node_Impl_Ptr<T>> &, const chaiscript::detail::Dispatch_State &t_ss) {
+                                    return run(*info, *loop, t_ss);
+                                  });
+      }
+
+    private:
+      enum class Purity {
+        pure,
+        impure,
+        script
+      };
+
+      template<typename T>
+      static void direct_ids(const eval::AST_Node_Impl<T> &node, std::vector<std::string> &ids) {
+        if (node.identifier == AST_Node_Type::Id) {
+          ids.push_back(node.text);
+        }
+      }
+
+      template<typename T>
+      static void all_ids(const eval::AST_Node_Impl<T> &node, std::vector<std::string> &ids) {
+        direct_ids(node, ids);
+        for (const auto &child : node.children) {
+          all_ids(*child, ids);
+        }
+      }
+
+      /// Collects what the loop can change. Returns false for loops containing constructs whose effects are not tracked
+      template<typename T>
+      static bool scan(const eval::AST_Node_Impl<T> &node, Loop_Info &info) {
+        const auto add_effect = [&info](const Effect_Kind kind, std::string name, std::string receiver) -> std::vector<std::string> & {
+          info.effects.push_back(Effect{kind, std::move(name), std::move(receiver), {}});
+          return info.effects.back().ids;
+        };
+
+        switch (node.identifier) {
+          case AST_Node_Type::Def:
+          case AST_Node_Type::Lambda:
+          case AST_Node_Type::Method:
+          case AST_Node_Type::Class:
+          case AST_Node_Type::Attr_Decl:
+          case AST_Node_Type::Global_Decl:
+          case AST_Node_Type::Reference:
+          case AST_Node_Type::Try:
+            return false;
+          case AST_Node_Type::Var_Decl:
+          case AST_Node_Type::Assign_Decl:
+            info.declared_ids.push_back(node.children[0]->text);
+            break;
+          case AST_Node_Type::Ranged_For: {
+            info.declared_ids.push_back(node.children[0]->text);
+            std::vector<std::string> range_ids;
+            all_ids(*node.children[1], range_ids);
+            info.aliases.emplace_back(node.children[0]->text, std::move(range_ids));
+            break;
+          }
+          case AST_Node_Type::Equation:
+            if (node.text == ":=") {
+              return false;
+            } else if (node.children[0]->identifier == AST_Node_Type::Id) {
+              info.written_ids.push_back(node.children[0]->text);
+            } else if (node.children[0]->identifier != AST_Node_Type::Var_Decl) {
+              all_ids(*node.children[0], add_effect(Effect_Kind::function, node.text, {}));
+            }
+            break;
+          case AST_Node_Type::Prefix:
+            if ((node.text == "++" || node.text == "--") && node.children[0]->identifier == AST_Node_Type::Id) {
+              info.written_ids.push_back(node.children[0]->text);
+            } else if (node.text == "++" || node.text == "--") {
+              all_ids(*node.children[0], add_effect(Effect_Kind::function, node.text, {}));
+            } else {
+              direct_ids(*node.children[0], add_effect(Effect_Kind::function, node.text, {}));
+            }
+            break;
+          case AST_Node_Type::Binary: {
+            auto &ids = add_effect(Effect_Kind::function, node.text, {});
+            for (const auto &child : node.children) {
+              direct_ids(*child, ids);
+            }
+            break;
+          }
+          case AST_Node_Type::Array_Call: {
+            auto &ids = add_effect(Effect_Kind::function, "[]", {});
+            for (const auto &child : node.children) {
+              direct_ids(*child, ids);
+            }
+            break;
+          }
+          case AST_Node_Type::Switch:
+            add_effect(Effect_Kind::function, "==", {});
+            break;
+          case AST_Node_Type::Fun_Call: {
+            if (node.children.size() != 2 || node.children[0]->identifier != AST_Node_Type::Id) {
+              return false;
+            }
+            auto &ids = add_effect(Effect_Kind::callee, node.children[0]->text, {});
+            for (const auto &arg : node.children[1]->children) {
+              direct_ids(*arg, ids);
+            }
+            return scan(*node.children[1], info);
+          }
+          case AST_Node_Type::Dot_Access: {
+            const auto &object = *node.children[0];
+            const auto &member = *node.children[1];
+            const auto receiver = object.identifier == AST_Node_Type::Id ? object.text : std::string();
+            if (member.identifier == AST_Node_Type::Fun_Call || member.identifier == AST_Node_Type::Array_Call) {
+              auto &ids = add_effect(Effect_Kind::method, member.children[0]->text, receiver);
+              direct_ids(object, ids);
+              if (member.identifier == AST_Node_Type::Fun_Call) {
+                for (const auto &arg : member.children[1]->children) {
+                  direct_ids(*arg, ids);
+                }
+              } else {
+                direct_ids(*member.children[1], add_effect(Effect_Kind::function, "[]", {}));
+              }
+              return scan(object, info) && scan(*member.children[1], info);
+            }
+            direct_ids(object, add_effect(Effect_Kind::attribute, member.text, receiver));
+            return scan(object, info);
+          }
+          case AST_Node_Type::Compiled:
+            if (!scan(*dynamic_cast<const eval::Compiled_AST_Node<T> &>(node).m_original_node, info)) {
+              return false;
+            }
+            break;
+          default:
+            break;
+        }
+
+        for (const auto &child : node.children) {
+          if (!scan(*child, info)) {
+            return false;
+          }
+        }
+
+        return true;
+      }
+
+      static bool changes(const Loop_Info &info, const std::string &name) {
+        return std::find(info.written_ids.begin(), info.written_ids.end(), name) != info.written_ids.end()
+            || std::find(info.declared_ids.begin(), info.declared_ids.end(), name) != info.declared_ids.end();
+      }
+
+      /// Whether node can be hoisted as a whole; t_calls is set if it calls a function, which a candidate has to
+      template<typename T>
+      static bool is_candidate(const eval::AST_Node_Impl<T> &node, const Loop_Info &info, Candidate &candidate, bool &t_calls) {
+        switch (node.identifier) {
+          case AST_Node_Type::Constant:
+            return true;
+          case AST_Node_Type::Id:
+            candidate.ids.push_back(node.text);
+            return !changes(info, node.text);
+          case AST_Node_Type::Binary:
+            candidate.functions.push_back(node.text);
+            return node.children.size() == 2 && is_candidate(*node.children[0], info, candidate, t_calls)
+                && is_candidate(*node.children[1], info, candidate, t_calls);
+          case AST_Node_Type::Prefix:
+            candidate.functions.push_back(node.text);
+            return (node.text == "-" || node.text == "+" || node.text == "!" || node.text == "~") && node.children.size() == 1
+                && is_candidate(*node.children[0], info, candidate, t_calls);
+          case AST_Node_Type::Fun_Call:
+            if (node.children.size() != 2 || node.children[0]->identifier != AST_Node_Type::Id || changes(info, node.children[0]->text)) {
+              return false;
+            }
+            t_calls = true;
+            candidate.callees.push_back(node.children[0]->text);
+            return std::all_of(node.children[1]->children.begin(), node.children[1]->children.end(), [&](const auto &arg) {
+              return is_candidate(*arg, info, candidate, t_calls);
+            });
+          case AST_Node_Type::Dot_Access: {
+            const auto &member = *node.children[1];
+            if (member.identifier != AST_Node_Type::Fun_Call || member.children.size() != 2) {
+              return false;
+            }
+            t_calls = true;
+            candidate.functions.push_back(member.children[0]->text);
+            if (node.children[0]->identifier == AST_Node_Type::Id) {
+              candidate.receivers.push_back(node.children[0]->text);
+            }
+            return is_candidate(*node.children[0], info, candidate, t_calls)
+                && std::all_of(member.children[1]->children.begin(), member.children[1]->children.end(), [&](const auto &arg) {
+                     return is_candidate(*arg, info, candidate, t_calls);
+                   });
+          }
+          default:
+            return false;
+        }
+      }
+
+      template<typename T>
+      static std::string structure(const eval::AST_Node_Impl<T> &node) {
+        auto key = std::to_string(static_cast<int>(node.identifier)) + ':' + node.text + '(';
+        for (const auto &child : node.children) {
+          key += structure(*child) + ',';
+        }
+        return key + ')';
+      }
+
+      /// Replaces the largest candidates under node; nested loops are left to their own pass
+      template<typename T>
+      static void hoist(eval::AST_Node_Impl_Ptr<T> &node, const std::shared_ptr<Loop_Info> &info, std::vector<std::string> &keys) {
+        switch (node->identifier) {
+          case AST_Node_Type::While:
+          case AST_Node_Type::For:
+          case AST_Node_Type::Ranged_For:
+          case AST_Node_Type::Compiled:
+            return;
+          default:
+            break;
+        }
+
+        Candidate candidate;
+        bool calls = false;
+        if (is_candidate(*node, *info, candidate, calls) && calls) {
+          const auto key = structure(*node);
+          const auto index = static_cast<std::size_t>(std::distance(keys.begin(), std::find(keys.begin(), keys.end(), key)));
+          if (index == keys.size()) {
+            keys.push_back(key);
+            info->candidates.push_back(std::move(candidate));
+          }
+
+          const auto *expr = node.get();
+          node = make_compiled_node(std::move(node),
+                                    {},
+                                    [info, index, expr](const std::vector<eval::AST_Node_Impl_Ptr<T>> &, const chaiscript::detail::Dispatch_State &t_ss) {
+                                      return eval_hoisted(*info, index, *expr, t_ss);
+                                    });
+          return;
+        }
+
+        if (node->identifier == AST_Node_Type::Dot_Access) {
+          // the member is a name, not a call by itself
+          hoist(node->children[0], info, keys);
+          auto &member = *node->children[1];
+          if (member.identifier == AST_Node_Type::Fun_Call) {
+            for (auto &arg : member.children[1]->children) {
+              hoist(arg, info, keys);
+            }
+          } else if (member.identifier == AST_Node_Type::Array_Call) {
+            hoist(member.children[1], info, keys);
+          }
+        } else if (node->identifier == AST_Node_Type::Equation) {
+          hoist(node->children[1], info, keys);
+        } else {
+          for (auto &child : node->children) {
+            hoist(child, info, keys);
+          }
+        }
+      }
+
+      static Purity purity(const dispatch::Proxy_Function_Base &t_func) {
+        if (t_func.is_pure()) {
+          return Purity::pure;
+        } else if (const auto *dispatch_func = dynamic_cast<const chaiscript::detail::Dispatch_Function *>(&t_func)) {
+          auto result = Purity::pure;
+          for (const auto &func : dispatch_func->get_contained_functions()) {
+            result = std::max(result, purity(*func));
+          }
+          return result;
+        } else if (dynamic_cast<const dispatch::Proxy_Function_Impl_Base *>(&t_func)
+                   && !dynamic_cast<const dispatch::Assignable_Proxy_Function *>(&t_func)) {
+          return Purity::impure;
+        } else {
+          return Purity::script;
+        }
+      }
+
+      /// Purity of a set of overloads; t_empty for a name without any
+      static Purity purity(const std::vector<Proxy_Function> &t_funcs, const Purity t_empty) {
+        if (t_funcs.empty()) {
+          return t_empty;
+        }
+
+        auto result = Purity::pure;
+        for (const auto &func : t_funcs) {
+          result = std::max(result, purity(*func));
+        }
+        return result;
+      }
+
+      static std::optional<Boxed_Value> find_object(const std::string &t_name, const chaiscript::detail::Dispatch_State &t_ss) {
+        try {
+          std::atomic_uint_fast32_t loc{0};
+          return t_ss.get_object(t_name, loc);
+        } catch (const std::exception &) {
+          return std::nullopt;
+        }
+      }
+
+      /// Purity of whatever a call through the variable or function t_name ends up in
+      static Purity callee_purity(const std::string &t_name, const chaiscript::detail::Dispatch_State &t_ss) {
+        try {
+          if (const auto object = find_object(t_name, t_ss)) {
+            return purity(*boxed_cast<const dispatch::Proxy_Function_Base *>(*object));
+          }
+        } catch (const exception::bad_boxed_cast &) {
+        }
+        return Purity::script;
+      }
+
+      /// A method call on a dynamic object may end up in a function stored in one of its attributes
+      static bool is_dynamic_object(const std::string &t_name, const chaiscript::detail::Dispatch_State &t_ss) {
+        const auto object = find_object(t_name, t_ss);
+        return !object || object->get_type_info().bare_equal(user_type<dispatch::Dynamic_Object>());
+      }
+
+      static bool contains(const std::vector<std::string> &t_names, const std::string &t_name) {
+        return std::find(t_names.begin(), t_names.end(), t_name) != t_names.end();
+      }
+
+      /// Runtime half of the proof: which candidates may be reused during this run of the loop
+      static std::vector<Slot> validate(const Loop_Info &info, const chaiscript::detail::Dispatch_State &t_ss) {
+        std::vector<Slot> slots(info.candidates.size());
+
+        const auto functions = [&t_ss](const std::string &t_name) { return t_ss->get_function(t_name, 0).second; };
+
+        std::vector<std::string> changed = info.written_ids;
+        for (const auto &effect : info.effects) {
+          auto result = Purity::pure;
+          switch (effect.kind) {
+            case Effect_Kind::function:
+              result = purity(*functions(effect.name), Purity::pure);
+              break;
+            case Effect_Kind::callee:
+              result = callee_purity(effect.name, t_ss);
+              break;
+            case Effect_Kind::method:
+              result = purity(*functions(effect.name), Purity::script);
+              if (!effect.receiver.empty() && is_dynamic_object(effect.receiver, t_ss)) {
+                result = Purity::script;
+              }
+              break;
+            case Effect_Kind::attribute:
+              result = purity(*functions(effect.name), Purity::pure);
+              break;
+          }
+
+          if (result == Purity::script) {
+            return slots;
+          } else if (result == Purity::impure) {
+            changed.insert(changed.end(), effect.ids.begin(), effect.ids.end());
+          }
+        }
+
+        // changing a ranged for's loop variable changes what it ranges over
+        for (std::size_t i = 0; i < info.aliases.size(); ++i) {
+          for (const auto &[loop_var, range_ids] : info.aliases) {
+            if (contains(changed, loop_var)) {
+              for (const auto &id : range_ids) {
+                if (!contains(changed, id)) {
+                  changed.push_back(id);
+                }
+              }
+            }
+          }
+        }
+
+        std::vector<const void *> changed_objects;
+        for (const auto &name : changed) {
+          if (!contains(info.declared_ids, name)) {
+            if (const auto object = find_object(name, t_ss)) {
+              changed_objects.push_back(object->get_const_ptr());
+            }
+          }
+        }
+
+        for (std::size_t i = 0; i < slots.size(); ++i) {
+          const auto &candidate = info.candidates[i];
+          slots[i].valid
+              = std::all_of(candidate.functions.begin(),
+                            candidate.functions.end(),
+                            [&](const auto &name) { return purity(*functions(name), Purity::script) == Purity::pure; })
+             && std::all_of(candidate.callees.begin(),
+                            candidate.callees.end(),
+                            [&](const auto &name) { return callee_purity(name, t_ss) == Purity::pure; })
+             && std::none_of(candidate.receivers.begin(),
+                             candidate.receivers.end(),
+                             [&](const auto &name) { return is_dynamic_object(name, t_ss); })
+             && std::none_of(candidate.ids.begin(), candidate.ids.end(), [&](const auto &name) {
+                  if (contains(changed, name)) {
+                    return true;
+                  }
+                  const auto object = find_object(name, t_ss);
+                  return object
+                      && std::find(changed_objects.begin(), changed_objects.end(), object->get_const_ptr()) != changed_objects.end();
+                });
+        }
+
+        return slots;
+      }
+
+      template<typename T>
+      static Boxed_Value eval_hoisted(const Loop_Info &info,
+                                      const std::size_t index,
+                                      const eval::AST_Node_Impl<T> &expr,
+                                      const chaiscript::detail::Dispatch_State &t_ss) {
+        {
+          const auto &slots = *info.slots;
+          if (index >= slots.size() || !slots[index].valid) {
+            return expr.eval(t_ss);
+          } else if (slots[index].cached) {
+            return eval::detail::copy_reusable_value(slots[index].value);
+          }
+        }
+
+        Boxed_Value result = expr.eval(t_ss);
+
+        auto &slot = (*info.slots)[index];
+        if (eval::detail::is_reusable_value(result)) {
+          slot.value = eval::detail::copy_reusable_value(result);
+          slot.cached = true;
+        } else {
+          slot.valid = false;
+        }
+        return result;
+      }
+
+      template<typename T>
+      static Boxed_Value run(const Loop_Info &info, const eval::AST_Node_Impl<T> &loop, const chaiscript::detail::Dispatch_State &t_ss) {
+        // a loop can run again inside itself through a recursive call, which gets slots of its own
+        struct Slots_Push_Pop {
+          Slots_Push_Pop(std::vector<Slot> &t_slots, std::vector<Slot> t_new)
+              : m_slots(t_slots)
+              , m_saved(std::exchange(t_slots, std::move(t_new))) {
+          }
+          ~Slots_Push_Pop() { m_slots = std::move(m_saved); }
+          Slots_Push_Pop(const Slots_Push_Pop &) = delete;
+          Slots_Push_Pop &operator=(const Slots_Push_Pop &) = delete;
+
+          std::vector<Slot> &m_slots;
+          std::vector<Slot> m_saved;
+        };
+
+        Slots_Push_Pop spp(*info.slots, validate(info, t_ss));
+        return loop.eval(t_ss);
       }
     };
 
@@ -421,11 +1586,19 @@ namespace chaiscript {
                                         optimizer::Unused_Return,
                                         optimizer::Constant_Fold,
                                         optimizer::If,
+                                        optimizer::Switch,
+                                        optimizer::Lazy_Range,
+                                        optimizer::Hash_Map_Literal,
+                                        optimizer::Append_Assign,
                                         optimizer::Return,
                                         optimizer::Dead_Code,
                                         optimizer::Block,
                                         optimizer::For_Loop,
-                                        optimizer::Assign_Decl>;
+                                        optimizer::Loop_Invariant,
+                                        optimizer::Assign_Decl,
+                                        optimizer::Fold_Pure_Call,
+                                        optimizer::Inline,
+                                        optimizer::Tail_Call>;
 
   } // namespace optimizer
 } // namespace chaiscript
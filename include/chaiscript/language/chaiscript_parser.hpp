@@ -2673,7 +2673,7 @@ namespace chaiscript {
         return retval;
       }
 
-      AST_NodePtr parse(const std::string &t_input, const std::string &t_fname) override {
+      AST_NodePtr parse(std::string_view t_input, const std::string &t_fname) override {
         ChaiScript_Parser<Tracer, Optimizer> parser(m_tracer, m_optimizer);
         return parser.parse_internal(t_input, t_fname);
       }
@@ -2693,7 +2693,7 @@ namespace chaiscript {
       }
 
       /// Parses the given input string, tagging parsed ast_nodes with the given m_filename.
-      AST_NodePtr parse_internal(const std::string &t_input, std::string t_fname) {
+      AST_NodePtr parse_internal(std::string_view t_input, std::string t_fname) {
         const auto begin = t_input.empty() ? nullptr : &t_input.front();
         const auto end = begin == nullptr ? nullptr : begin + t_input.size();
         m_position = Position(begin, end);
@@ -9,6 +9,9 @@
 
 namespace chaiscript {
   struct ChaiScript_Prelude {
+    /// The file name the prelude is evaluated under, which tells the functions it defines from a script's
+    static constexpr const char *filename = "standard prelude";
+
     static std::string chaiscript_prelude() {
       return R"chaiscript(
 
@@ -0,0 +1,154 @@
+// This file is distributed under the BSD License.
+// See "license.txt" for details.
+// Copyright 2009-2012, Jonathan Turner (jonathan@emptycrate.com)
+// Copyright 2009-2018, Jason Turner (jason@emptycrate.com)
+// http://www.chaiscript.com
+
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#ifndef CHAISCRIPT_UTILITY_INTERNED_STRING_HPP_
+#define CHAISCRIPT_UTILITY_INTERNED_STRING_HPP_
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "../chaiscript_threading.hpp"
+#include "hash.hpp"
+
+namespace chaiscript::utility {
+  /// A name kept once for the whole process. Equal names share one entry, so two Interned_Strings are equal
+  /// exactly when they point to the same entry, and the hash of the text is worked out once, when it is
+  /// first interned. Entries are never freed, so only names with a bounded supply, such as those given at
+  /// registration, should be interned; names in script text go through Lazy_Interned_String, and text made up
+  /// at runtime should be looked up as it is.
+  class Interned_String {
+  public:
+    /// The empty name
+    Interned_String() noexcept = default;
+
+    explicit Interned_String(const std::string_view t_text)
+        : m_entry(intern(t_text)) {
+    }
+
+    const std::string &str() const noexcept { return m_entry != nullptr ? m_entry->text : empty_text(); }
+
+    operator const std::string &() const noexcept { return str(); }
+
+    /// utility::hash of the text
+    std::uint32_t hash() const noexcept { return m_entry != nullptr ? m_entry->hash : utility::hash(std::string_view()); }
+
+    std::size_t size() const noexcept { return str().size(); }
+
+    bool empty() const noexcept { return m_entry == nullptr; }
+
+    auto begin() const noexcept { return str().begin(); }
+
+    auto end() const noexcept { return str().end(); }
+
+    friend bool operator==(const Interned_String &t_lhs, const Interned_String &t_rhs) noexcept { return t_lhs.m_entry == t_rhs.m_entry; }
+
+    friend bool operator==(const Interned_String &t_lhs, const std::string_view t_rhs) noexcept { return t_lhs.str() == t_rhs; }
+
+    /// Hashes names, interned or not, to the same value for the same text. An Interned_String gives its cached hash.
+    struct Hash {
+      using is_transparent = void;
+
+      std::size_t operator()(const Interned_String &t_name) const noexcept { return t_name.hash(); }
+
+      std::size_t operator()(const std::string_view t_text) const noexcept { return utility::hash(t_text); }
+    };
+
+    /// Compares names, interned or not. Two Interned_Strings are compared by address alone.
+    struct Equal {
+      using is_transparent = void;
+
+      bool operator()(const Interned_String &t_lhs, const Interned_String &t_rhs) const noexcept { return t_lhs == t_rhs; }
+
+      bool operator()(const Interned_String &t_lhs, const std::string_view t_rhs) const noexcept { return t_lhs == t_rhs; }
+
+      bool operator()(const std::string_view t_lhs, const Interned_String &t_rhs) const noexcept { return t_rhs == t_lhs; }
+
+      bool operator()(const std::string_view t_lhs, const std::string_view t_rhs) const noexcept { return t_lhs == t_rhs; }
+    };
+
+  private:
+    friend class Lazy_Interned_String;
+
+    struct Entry {
+      std::string text;
+      std::uint32_t hash;
+    };
+
+    explicit Interned_String(const Entry *t_entry) noexcept
+        : m_entry(t_entry) {
+    }
+
+    static const std::string &empty_text() noexcept {
+      static const std::string empty;
+      return empty;
+    }
+
+    static const Entry *intern(const std::string_view t_text) {
+      if (t_text.empty()) {
+        return nullptr;
+      }
+
+      // never destroyed, so that names held by other statics stay valid however late those are torn down.
+      // The entries never move, so the keys can view their text.
+      static auto &mutex = *new chaiscript::detail::threading::shared_mutex();
+      static auto &entries = *new std::deque<Entry>();
+      static auto &index = *new std::unordered_map<std::string_view, const Entry *, Hash>();
+
+      {
+        chaiscript::detail::threading::shared_lock<chaiscript::detail::threading::shared_mutex> l(mutex);
+        if (const auto itr = index.find(t_text); itr != index.end()) {
+          return itr->second;
+        }
+      }
+
+      chaiscript::detail::threading::unique_lock<chaiscript::detail::threading::shared_mutex> l(mutex);
+      if (const auto itr = index.find(t_text); itr != index.end()) {
+        return itr->second;
+      }
+      const auto &entry = entries.emplace_back(Entry{std::string(t_text), utility::hash(t_text)});
+      index.emplace(entry.text, &entry);
+      return &entry;
+    }
+
+    const Entry *m_entry = nullptr;
+  };
+
+  /// A name from script text that is interned only once something asks for it, the first time it reaches
+  /// a global or function lookup. Names that only ever refer to locals, and code that is parsed but never
+  /// run that far, add nothing to the process-wide table. The text stays with the owner, which must pass
+  /// the same text on every call.
+  class Lazy_Interned_String {
+  public:
+    Lazy_Interned_String() noexcept = default;
+
+    Lazy_Interned_String(const Lazy_Interned_String &) = delete;
+    Lazy_Interned_String &operator=(const Lazy_Interned_String &) = delete;
+
+    /// \returns the interned t_text, interning it on the first call
+    Interned_String get(const std::string_view t_text) const {
+      if (const auto *entry = m_entry.load(std::memory_order_acquire); entry != nullptr || t_text.empty()) {
+        return Interned_String(entry);
+      }
+
+      // threads racing here all intern the same entry, so whichever store lands last changes nothing
+      const Interned_String name(t_text);
+      m_entry.store(name.m_entry, std::memory_order_release);
+      return name;
+    }
+
+  private:
+    mutable std::atomic<const Interned_String::Entry *> m_entry = {nullptr};
+  };
+} // namespace chaiscript::utility
+
+#endif
@@ -0,0 +1,395 @@
+// This file is distributed under the BSD License.
+// See "license.txt" for details.
+// Copyright 2009-2012, Jonathan Turner (jonathan@emptycrate.com)
+// Copyright 2009-2018, Jason Turner (jason@emptycrate.com)
+// http://www.chaiscript.com
+
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#ifndef CHAISCRIPT_JSON_READER_HPP_
+#define CHAISCRIPT_JSON_READER_HPP_
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "../chaiscript_defines.hpp"
+#include "../dispatchkit/boxed_value.hpp"
+#include "json_scan.hpp"
+
+namespace chaiscript::json {
+  /// Parses JSON text straight into the values scripts use for it: a Map for an object, a Vector for an array,
+  /// and string, double, int64_t, bool or a null Boxed_Value for the rest. Unlike JSON::Load, no JSON tree is
+  /// built in between.
+  ///
+  /// It accepts what JSONParser accepts. Integers that do not fit an int64_t are read as doubles.
+  /// Other numbers are worked out as JSONParser and script literals do, so they compare equal to both.
+  class Boxed_Value_Reader {
+  public:
+    explicit Boxed_Value_Reader(std::string_view t_json) noexcept
+        : m_pos(t_json.data())
+        , m_end(t_json.data() + t_json.size()) {
+    }
+
+    /// \returns the first value in t_json, anything after it is ignored
+    /// \throws std::out_of_range if t_json ends before the value does
+    /// \throws std::runtime_error if t_json is not valid JSON
+    static Boxed_Value parse(std::string_view t_json) { return Boxed_Value_Reader(t_json).parse_next(); }
+
+    /// Parses the next value, leaving whatever follows it for the next call
+    Boxed_Value parse_next() {
+      consume_ws();
+      switch (peek()) {
+        case '[':
+          return parse_array();
+        case '{':
+          return parse_object();
+        case '\"':
+          return Boxed_Value(parse_string());
+        case 't':
+        case 'f':
+          return parse_bool();
+        case 'n':
+          return parse_null();
+        default:
+          if ((peek() <= '9' && peek() >= '0') || peek() == '-') {
+            return parse_number();
+          }
+      }
+      throw std::runtime_error(std::string("JSON ERROR: Parse: Unexpected starting character '") + peek() + "'");
+    }
+
+    /// \returns the text that has not been parsed yet
+    std::string_view remaining() const noexcept { return std::string_view(m_pos, static_cast<std::size_t>(m_end - m_pos)); }
+
+  private:
+    static constexpr bool ends_number(const char c) noexcept { return detail::is_space(c) || c == ',' || c == ']' || c == '}'; }
+
+    static constexpr bool is_digit(const char c) noexcept { return c >= '0' && c <= '9'; }
+
+    char peek() const {
+      if (m_pos == m_end) {
+        throw std::out_of_range("JSON ERROR: Unexpected end of input");
+      }
+      return *m_pos;
+    }
+
+    char next() {
+      const char c = peek();
+      ++m_pos;
+      return c;
+    }
+
+    void consume_ws() noexcept { m_pos = detail::Scanner::skip_space(m_pos, m_end); }
+
+    Boxed_Value parse_object() {
+      std::map<std::string, Boxed_Value> object;
+
+      ++m_pos;
+      consume_ws();
+      if (peek() == '}') {
+        ++m_pos;
+        return Boxed_Value(std::move(object));
+      }
+
+      while (true) {
+        consume_ws();
+        if (peek() != '\"') {
+          throw std::runtime_error(std::string("JSON ERROR: Object: Expected string key, found '") + peek() + "'\n");
+        }
+        auto key = parse_string();
+        consume_ws();
+        if (peek() != ':') {
+          throw std::runtime_error(std::string("JSON ERROR: Object: Expected colon, found '") + peek() + "'\n");
+        }
+        ++m_pos;
+
+        // keys written in order go in at the end without a search, a repeated key keeps its last value
+        object.insert_or_assign(object.end(), std::move(key), parse_next());
+
+        consume_ws();
+        const char c = next();
+        if (c == '}') {
+          return Boxed_Value(std::move(object));
+        } else if (c != ',') {
+          throw std::runtime_error(std::string("JSON ERROR: Object: Expected comma, found '") + c + "'\n");
+        }
+      }
+    }
+
+    Boxed_Value parse_array() {
+      std::vector<Boxed_Value> array;
+
+      ++m_pos;
+      consume_ws();
+      if (peek() == ']') {
+        ++m_pos;
+        return Boxed_Value(std::move(array));
+      }
+
+      while (true) {
+        array.push_back(parse_next());
+        consume_ws();
+        const char c = next();
+        if (c == ']') {
+          return Boxed_Value(std::move(array));
+        } else if (c != ',') {
+          throw std::runtime_error(std::string("JSON ERROR: Array: Expected ',' or ']', found '") + c + "'\n");
+        }
+      }
+    }
+
+    std::string parse_string() {
+      std::string val;
+      ++m_pos;
+
+      while (true) {
+        // copy the run of plain characters in one go
+        const char *run = m_pos;
+        m_pos = detail::Scanner::find_string_run_end(m_pos, m_end);
+        val.append(run, m_pos);
+
+        if (next() == '\"') {
+          return val;
+        }
+
+        switch (const char c = next()) {
+          case '\"':
+          case '\\':
+          case '/':
+            val += c;
+            break;
+          case 'b':
+            val += '\b';
+            break;
+          case 'f':
+            val += '\f';
+            break;
+          case 'n':
+            val += '\n';
+            break;
+          case 'r':
+            val += '\r';
+            break;
+          case 't':
+            val += '\t';
+            break;
+          case 'u':
+            // kept as written, as JSONParser does
+            val += "\\u";
+            for (int i = 0; i < 4; ++i) {
+              const char h = next();
+              if (is_digit(h) || (h >= 'a' && h <= 'f') || (h >= 'A' && h <= 'F')) {
+                val += h;
+              } else {
+                throw std::runtime_error(std::string("JSON ERROR: String: Expected hex character in unicode escape, found '") + h + "'");
+              }
+            }
+            break;
+          default:
+            val += '\\';
+            break;
+        }
+      }
+    }
+
+    Boxed_Value parse_number() {
+      const char *const start = m_pos;
+      const bool negative = *m_pos == '-';
+      bool is_double = false;
+
+      if (negative) {
+        ++m_pos;
+      }
+
+      const char *const digits = m_pos;
+      for (; m_pos != m_end; ++m_pos) {
+        if (*m_pos == '.' && !is_double) {
+          is_double = true;
+        } else if (!is_digit(*m_pos)) {
+          break;
+        }
+      }
+      const char *const digits_end = m_pos;
+
+      if (m_pos != m_end && (*m_pos == 'e' || *m_pos == 'E')) {
+        ++m_pos;
+        const bool negative_exponent = m_pos != m_end && *m_pos == '-';
+        if (m_pos != m_end && (*m_pos == '-' || *m_pos == '+')) {
+          ++m_pos;
+        }
+        const char *const exponent = m_pos;
+        while (m_pos != m_end && is_digit(*m_pos)) {
+          ++m_pos;
+        }
+        if (m_pos != m_end && !ends_number(*m_pos)) {
+          throw std::runtime_error(std::string("JSON ERROR: Number: Expected a number for exponent, found '") + *m_pos + "'");
+        }
+
+        const auto exp = parse_num<std::int64_t>(std::string_view(exponent, static_cast<std::size_t>(m_pos - exponent)));
+        return Boxed_Value(mantissa(negative, is_double, digits, digits_end) * std::pow(10, negative_exponent ? -exp : exp));
+      } else if (m_pos != m_end && !ends_number(*m_pos)) {
+        throw std::runtime_error(std::string("JSON ERROR: Number: unexpected character '") + *m_pos + "'");
+      }
+
+      if (is_double) {
+        return Boxed_Value(mantissa(negative, is_double, digits, digits_end));
+      }
+
+      std::int64_t i = 0;
+      const auto [ptr, ec] = std::from_chars(start, m_pos, i);
+      if (ec == std::errc() && ptr == m_pos) {
+        return Boxed_Value(i);
+      } else if (ec == std::errc::result_out_of_range) {
+        return Boxed_Value(mantissa(negative, is_double, digits, digits_end));
+      } else {
+        throw std::runtime_error(std::string("JSON ERROR: Number: Expected digits, found '") + std::string(start, m_pos) + "'");
+      }
+    }
+
+    /// The digits of a number as a double, worked out as script literals are so that the two compare equal
+    static double mantissa(const bool t_negative, const bool t_is_double, const char *t_begin, const char *t_end) {
+      const std::string_view digits(t_begin, static_cast<std::size_t>(t_end - t_begin));
+      const double value = t_is_double ? parse_num<double>(digits) : static_cast<double>(parse_num<std::uint64_t>(digits));
+      return t_negative ? -value : value;
+    }
+
+    Boxed_Value parse_bool() {
+      if (remaining().substr(0, 4) == "true") {
+        m_pos += 4;
+        return Boxed_Value(true);
+      } else if (remaining().substr(0, 5) == "false") {
+        m_pos += 5;
+        return Boxed_Value(false);
+      } else {
+        throw std::runtime_error(std::string("JSON ERROR: Bool: Expected 'true' or 'false', found '") + std::string(remaining().substr(0, 5)) + "'");
+      }
+    }
+
+    Boxed_Value parse_null() {
+      if (remaining().substr(0, 4) != "null") {
+        throw std::runtime_error(std::string("JSON ERROR: Null: Expected 'null', found '") + std::string(remaining().substr(0, 4)) + "'");
+      }
+      m_pos += 4;
+      return Boxed_Value();
+    }
+
+    const char *m_pos;
+    const char *m_end;
+  };
+
+  /// Reads newline delimited JSON, one value per line, a line at a time. Only the current line and the value
+  /// parsed from it are held, so memory use does not grow with the size of the input. Blank lines are skipped.
+  ///
+  /// It is a range: empty(), front() and pop_front() pull the values one by one, and begin() and end() let a
+  /// ranged `for` walk them. Either way the values are consumed as they go.
+  class NDJSON_Reader {
+  public:
+    explicit NDJSON_Reader(std::unique_ptr<std::istream> t_in)
+        : m_in(std::move(t_in)) {
+      advance();
+    }
+
+    /// \throws std::runtime_error if t_filename cannot be opened
+    static std::shared_ptr<NDJSON_Reader> from_file(const std::string &t_filename) {
+      auto in = std::make_unique<std::ifstream>(t_filename, std::ios::in | std::ios::binary);
+      if (!in->is_open()) {
+        throw std::runtime_error("Unable to open JSON file '" + t_filename + "'");
+      }
+      return std::make_shared<NDJSON_Reader>(std::move(in));
+    }
+
+    static std::shared_ptr<NDJSON_Reader> from_string(std::string t_text) {
+      return std::make_shared<NDJSON_Reader>(std::make_unique<std::istringstream>(std::move(t_text)));
+    }
+
+    bool empty() const noexcept { return m_done; }
+
+    const Boxed_Value &front() const {
+      if (empty()) {
+        throw std::range_error("Range empty");
+      }
+      return m_current;
+    }
+
+    void pop_front() {
+      if (empty()) {
+        throw std::range_error("Range empty");
+      }
+      advance();
+    }
+
+    /// The line the value at the front came from, counting from 1
+    std::size_t line_number() const noexcept { return m_line_number; }
+
+    struct sentinel {
+    };
+
+    class iterator {
+    public:
+      explicit iterator(NDJSON_Reader &t_reader) noexcept
+          : m_reader(&t_reader) {
+      }
+
+      const Boxed_Value &operator*() const { return m_reader->front(); }
+      iterator &operator++() {
+        m_reader->pop_front();
+        return *this;
+      }
+      bool operator==(sentinel) const noexcept { return m_reader->empty(); }
+
+    private:
+      NDJSON_Reader *m_reader;
+    };
+
+    iterator begin() noexcept { return iterator(*this); }
+    sentinel end() const noexcept { return {}; }
+
+  private:
+    static bool is_blank(std::string_view t_text) noexcept {
+      return detail::Scanner::skip_space(t_text.data(), t_text.data() + t_text.size()) == t_text.data() + t_text.size();
+    }
+
+    void advance() {
+      while (std::getline(*m_in, m_line)) {
+        ++m_line_number;
+        if (is_blank(m_line)) {
+          continue;
+        }
+
+        try {
+          Boxed_Value_Reader reader(m_line);
+          m_current = reader.parse_next();
+          if (!is_blank(reader.remaining())) {
+            throw std::runtime_error("JSON ERROR: Expected one value per line, found '" + std::string(reader.remaining()) + "'");
+          }
+        } catch (const std::exception &e) {
+          throw std::runtime_error("Line " + std::to_string(m_line_number) + ": " + e.what());
+        }
+        return;
+      }
+
+      m_done = true;
+      m_current = Boxed_Value();
+    }
+
+    std::unique_ptr<std::istream> m_in;
+    std::string m_line;
+    std::size_t m_line_number = 0;
+    Boxed_Value m_current;
+    bool m_done = false;
+  };
+} // namespace chaiscript::json
+
+#endif
@@ -0,0 +1,170 @@
+// This file is distributed under the BSD License.
+// See "license.txt" for details.
+// Copyright 2009-2012, Jonathan Turner (jonathan@emptycrate.com)
+// Copyright 2009-2018, Jason Turner (jason@emptycrate.com)
+// http://www.chaiscript.com
+
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#ifndef CHAISCRIPT_JSON_SCAN_HPP_
+#define CHAISCRIPT_JSON_SCAN_HPP_
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+// Define CHAISCRIPT_NO_SIMD to scan one character at a time everywhere
+#if !defined(CHAISCRIPT_NO_SIMD)
+#if defined(__AVX2__)
+#define CHAISCRIPT_JSON_AVX2
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define CHAISCRIPT_JSON_SSE2
+#endif
+#endif
+
+#if defined(CHAISCRIPT_JSON_AVX2) || defined(CHAISCRIPT_JSON_SSE2)
+#include <immintrin.h>
+#endif
+
+namespace chaiscript::json::detail {
+  /// The characters JSON skips between tokens, the same set as ::isspace in the "C" locale
+  constexpr bool is_space(const char c) noexcept { return c == ' ' || (c >= '\t' && c <= '\r'); }
+
+  /// A character that ends a run of plain characters in a JSON string
+  constexpr bool ends_string_run(const char c) noexcept { return c == '\"' || c == '\\'; }
+
+  /// A character that to_json might write as an escape sequence: quote, backslash and the control characters
+  constexpr bool may_need_escape(const char c) noexcept { return ends_string_run(c) || static_cast<unsigned char>(c) < 0x20; }
+
+  /// The scans the JSON reader and writer make over runs of characters, one character at a time.
+  /// Each returns the first character of interest in [t_begin, t_end), or t_end if there is none.
+  struct Scalar_Scanner {
+    static const char *skip_space(const char *t_begin, const char *t_end) noexcept {
+      return find(t_begin, t_end, [](const char c) { return !is_space(c); });
+    }
+
+    static const char *find_string_run_end(const char *t_begin, const char *t_end) noexcept {
+      return find(t_begin, t_end, ends_string_run);
+    }
+
+    static const char *find_escape(const char *t_begin, const char *t_end) noexcept { return find(t_begin, t_end, may_need_escape); }
+
+    template<typename Pred>
+    static const char *find(const char *t_begin, const char *t_end, Pred t_pred) noexcept {
+      while (t_begin != t_end && !t_pred(*t_begin)) {
+        ++t_begin;
+      }
+      return t_begin;
+    }
+  };
+
+  /// The same scans, a block of characters at a time. Block gives the width of a block and, for a block loaded
+  /// from memory, a bit mask of the characters each scan looks for. The tail shorter than a block is left to
+  /// Scalar_Scanner.
+  template<typename Block>
+  struct Block_Scanner {
+    static const char *skip_space(const char *t_begin, const char *t_end) noexcept {
+      // most runs of white space are a single character, or none
+      if (t_begin == t_end || !is_space(*t_begin)) {
+        return t_begin;
+      }
+      return find(t_begin, t_end, &Block::non_space, &Scalar_Scanner::skip_space);
+    }
+
+    static const char *find_string_run_end(const char *t_begin, const char *t_end) noexcept {
+      return find(t_begin, t_end, &Block::string_run_end, &Scalar_Scanner::find_string_run_end);
+    }
+
+    static const char *find_escape(const char *t_begin, const char *t_end) noexcept {
+      return find(t_begin, t_end, &Block::escape, &Scalar_Scanner::find_escape);
+    }
+
+  private:
+    template<typename Mask, typename Tail>
+    static const char *find(const char *t_begin, const char *t_end, Mask t_mask, Tail t_tail) noexcept {
+      while (t_end - t_begin >= static_cast<std::ptrdiff_t>(Block::width)) {
+        if (const auto mask = t_mask(t_begin); mask != 0) {
+          return t_begin + std::countr_zero(mask);
+        }
+        t_begin += Block::width;
+      }
+      return t_tail(t_begin, t_end);
+    }
+  };
+
+#if defined(CHAISCRIPT_JSON_SSE2)
+  struct SSE2_Block {
+    static constexpr std::size_t width = 16;
+
+    static __m128i load(const char *t_pos) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i *>(t_pos)); }
+
+    static std::uint32_t mask(const __m128i t_matches) noexcept { return static_cast<std::uint32_t>(_mm_movemask_epi8(t_matches)); }
+
+    static __m128i equal(const __m128i t_chars, const char t_c) noexcept { return _mm_cmpeq_epi8(t_chars, _mm_set1_epi8(t_c)); }
+
+    /// Characters between t_low and t_high, exclusive, compared as signed so that bytes of 0x80 and up are never in range
+    static __m128i between(const __m128i t_chars, const char t_low, const char t_high) noexcept {
+      return _mm_and_si128(_mm_cmpgt_epi8(t_chars, _mm_set1_epi8(t_low)), _mm_cmpgt_epi8(_mm_set1_epi8(t_high), t_chars));
+    }
+
+    static std::uint32_t non_space(const char *t_pos) noexcept {
+      const auto chars = load(t_pos);
+      return ~mask(_mm_or_si128(equal(chars, ' '), between(chars, '\t' - 1, '\r' + 1))) & 0xFFFFu;
+    }
+
+    static std::uint32_t string_run_end(const char *t_pos) noexcept {
+      const auto chars = load(t_pos);
+      return mask(_mm_or_si128(equal(chars, '\"'), equal(chars, '\\')));
+    }
+
+    static std::uint32_t escape(const char *t_pos) noexcept {
+      const auto chars = load(t_pos);
+      return mask(_mm_or_si128(_mm_or_si128(equal(chars, '\"'), equal(chars, '\\')), between(chars, -1, 0x20)));
+    }
+  };
+#endif
+
+#if defined(CHAISCRIPT_JSON_AVX2)
+  struct AVX2_Block {
+    static constexpr std::size_t width = 32;
+
+    static __m256i load(const char *t_pos) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(t_pos)); }
+
+    static std::uint32_t mask(const __m256i t_matches) noexcept { return static_cast<std::uint32_t>(_mm256_movemask_epi8(t_matches)); }
+
+    static __m256i equal(const __m256i t_chars, const char t_c) noexcept { return _mm256_cmpeq_epi8(t_chars, _mm256_set1_epi8(t_c)); }
+
+    static __m256i between(const __m256i t_chars, const char t_low, const char t_high) noexcept {
+      return _mm256_and_si256(_mm256_cmpgt_epi8(t_chars, _mm256_set1_epi8(t_low)), _mm256_cmpgt_epi8(_mm256_set1_epi8(t_high), t_chars));
+    }
+
+    static std::uint32_t non_space(const char *t_pos) noexcept {
+      const auto chars = load(t_pos);
+      return ~mask(_mm256_or_si256(equal(chars, ' '), between(chars, '\t' - 1, '\r' + 1)));
+    }
+
+    static std::uint32_t string_run_end(const char *t_pos) noexcept {
+      const auto chars = load(t_pos);
+      return mask(_mm256_or_si256(equal(chars, '\"'), equal(chars, '\\')));
+    }
+
+    static std::uint32_t escape(const char *t_pos) noexcept {
+      const auto chars = load(t_pos);
+      return mask(_mm256_or_si256(_mm256_or_si256(equal(chars, '\"'), equal(chars, '\\')), between(chars, -1, 0x20)));
+    }
+  };
+#endif
+
+  /// The widest scanner the target instruction set has, picked when compiling
+#if defined(CHAISCRIPT_JSON_AVX2)
+  using Scanner = Block_Scanner<AVX2_Block>;
+#elif defined(CHAISCRIPT_JSON_SSE2)
+  using Scanner = Block_Scanner<SSE2_Block>;
+#else
+  using Scanner = Scalar_Scanner;
+#endif
+} // namespace chaiscript::json::detail
+
+#endif
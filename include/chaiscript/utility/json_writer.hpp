@@ -0,0 +1,189 @@
+// This file is distributed under the BSD License.
+// See "license.txt" for details.
+// Copyright 2009-2012, Jonathan Turner (jonathan@emptycrate.com)
+// Copyright 2009-2018, Jason Turner (jason@emptycrate.com)
+// http://www.chaiscript.com
+
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#ifndef CHAISCRIPT_JSON_WRITER_HPP_
+#define CHAISCRIPT_JSON_WRITER_HPP_
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "../dispatchkit/boxed_cast.hpp"
+#include "../dispatchkit/boxed_number.hpp"
+#include "../dispatchkit/boxed_value.hpp"
+#include "../dispatchkit/dynamic_object.hpp"
+#include "json_scan.hpp"
+
+namespace chaiscript::json {
+  /// Writes Boxed_Values out as JSON text, in the same layout as JSON::dump. The type of each value is looked up
+  /// once instead of tried with casts, containers are walked in place, and the text is appended straight to the
+  /// output, which can be reused from one document to the next.
+  class Boxed_Value_Writer {
+  public:
+    explicit Boxed_Value_Writer(std::string &t_out) noexcept
+        : m_out(t_out) {
+    }
+
+    /// Appends t_bv to the output
+    /// \throws std::runtime_error if t_bv, or a value inside it, has no JSON form
+    void write(const Boxed_Value &t_bv) { write(t_bv, 1); }
+
+  private:
+    void write(const Boxed_Value &t_bv, const std::size_t t_depth) {
+      const auto &type = t_bv.get_type_info();
+
+      if (t_bv.is_null()) {
+        m_out += "null";
+      } else if (type.bare_equal(user_type<std::map<std::string, Boxed_Value>>())) {
+        write_object(boxed_cast<const std::map<std::string, Boxed_Value> &>(t_bv), t_depth);
+      } else if (type.bare_equal(user_type<std::vector<Boxed_Value>>())) {
+        write_array(boxed_cast<const std::vector<Boxed_Value> &>(t_bv), t_depth);
+      } else if (type.is_arithmetic() && !type.bare_equal(user_type<bool>())) {
+        const Boxed_Number bn(t_bv);
+        if (Boxed_Number::is_floating_point(t_bv)) {
+          write_double(bn.get_as<double>());
+        } else {
+          write_int(bn.get_as<std::int64_t>());
+        }
+      } else if (type.bare_equal(user_type<bool>())) {
+        m_out += boxed_cast<bool>(t_bv) ? "true" : "false";
+      } else if (type.bare_equal(user_type<std::string>())) {
+        write_string(boxed_cast<const std::string &>(t_bv));
+      } else if (type.bare_equal(user_type<dispatch::Dynamic_Object>())) {
+        write_object(boxed_cast<const dispatch::Dynamic_Object &>(t_bv), t_depth);
+      } else {
+        throw std::runtime_error("Unknown object type to convert to JSON");
+      }
+    }
+
+    void write_object(const std::map<std::string, Boxed_Value> &t_map, const std::size_t t_depth) {
+      m_out += "{\n";
+      bool first = true;
+      for (const auto &[key, value] : t_map) {
+        write_member(first, key, value, t_depth);
+      }
+      close_object(t_depth);
+    }
+
+    void write_object(const dispatch::Dynamic_Object &t_obj, const std::size_t t_depth) {
+      // attributes are written by name, as they would be from get_attrs()
+      const auto &names = t_obj.get_shape()->attr_names();
+      std::vector<std::size_t> order(names.size());
+      std::iota(order.begin(), order.end(), std::size_t{0});
+      std::sort(order.begin(), order.end(), [&names](const std::size_t lhs, const std::size_t rhs) { return names[lhs] < names[rhs]; });
+
+      m_out += "{\n";
+      bool first = true;
+      for (const auto index : order) {
+        write_member(first, names[index], t_obj.get_slot(index), t_depth);
+      }
+      close_object(t_depth);
+    }
+
+    void write_member(bool &t_first, const std::string &t_key, const Boxed_Value &t_value, const std::size_t t_depth) {
+      if (!t_first) {
+        m_out += ",\n";
+      }
+      t_first = false;
+      m_out.append(t_depth * 2, ' ');
+      write_string(t_key);
+      m_out += " : ";
+      write(t_value, t_depth + 1);
+    }
+
+    void close_object(const std::size_t t_depth) {
+      m_out += '\n';
+      m_out.append((t_depth - 1) * 2, ' ');
+      m_out += '}';
+    }
+
+    void write_array(const std::vector<Boxed_Value> &t_vec, const std::size_t t_depth) {
+      m_out += '[';
+      bool first = true;
+      for (const auto &value : t_vec) {
+        if (!first) {
+          m_out += ", ";
+        }
+        first = false;
+        write(value, t_depth + 1);
+      }
+      m_out += ']';
+    }
+
+    void write_string(const std::string_view t_str) {
+      m_out += '\"';
+      const char *run = t_str.data();
+      const char *const end = t_str.data() + t_str.size();
+      for (const char *c = detail::Scanner::find_escape(run, end); c != end; c = detail::Scanner::find_escape(c + 1, end)) {
+        const char *escape = nullptr;
+        switch (*c) {
+          case '\"':
+            escape = "\\\"";
+            break;
+          case '\\':
+            escape = "\\\\";
+            break;
+          case '\b':
+            escape = "\\b";
+            break;
+          case '\f':
+            escape = "\\f";
+            break;
+          case '\n':
+            escape = "\\n";
+            break;
+          case '\r':
+            escape = "\\r";
+            break;
+          case '\t':
+            escape = "\\t";
+            break;
+          default:
+            // other control characters are written as they are
+            continue;
+        }
+        m_out.append(run, c);
+        m_out += escape;
+        run = c + 1;
+      }
+      m_out.append(run, end);
+      m_out += '\"';
+    }
+
+    void write_int(const std::int64_t t_value) {
+      char buffer[24];
+      const auto result = std::to_chars(buffer, buffer + sizeof(buffer), t_value);
+      m_out.append(buffer, result.ptr);
+    }
+
+    /// Six places after the point, as std::to_string writes it, but always with a '.' whatever the locale
+    void write_double(const double t_value) {
+#if defined(__cpp_lib_to_chars)
+      char buffer[512];
+      const auto result = std::to_chars(buffer, buffer + sizeof(buffer), t_value, std::chars_format::fixed, 6);
+      if (result.ec == std::errc()) {
+        m_out.append(buffer, result.ptr);
+        return;
+      }
+#endif
+      m_out += std::to_string(t_value);
+    }
+
+    std::string &m_out;
+  };
+} // namespace chaiscript::json
+
+#endif
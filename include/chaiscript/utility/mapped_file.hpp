@@ -0,0 +1,135 @@
+// This file is distributed under the BSD License.
+// See "license.txt" for details.
+// Copyright 2009-2012, Jonathan Turner (jonathan@emptycrate.com)
+// Copyright 2009-2018, Jason Turner (jason@emptycrate.com)
+// http://www.chaiscript.com
+
+// This is an open source non-commercial project. Dear PVS-Studio, please check it.
+// PVS-Studio Static Code Analyzer for C, C++ and C#: http://www.viva64.com
+
+#ifndef CHAISCRIPT_UTILITY_MAPPED_FILE_HPP_
+#define CHAISCRIPT_UTILITY_MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#if defined(__linux__) || defined(__unix__) || defined(__APPLE__) || defined(__HAIKU__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+#define CHAISCRIPT_HAS_MMAP
+#endif
+
+namespace chaiscript::utility {
+  /// The contents of a file, read-only. A regular file is mapped into memory where the platform allows it,
+  /// so reading it copies nothing and only the pages actually looked at are loaded. Anything else, such as a
+  /// pipe, or any file on a platform without mapping, is read into memory instead. A mapped file must not be
+  /// truncated while it is mapped, so a mapping should be held no longer than the contents are needed.
+  class Mapped_File {
+  public:
+    /// Leaves this closed if t_filename cannot be opened
+    explicit Mapped_File(const std::string &t_filename) {
+#ifdef CHAISCRIPT_HAS_MMAP
+      const int fd = ::open(t_filename.c_str(), O_RDONLY | O_CLOEXEC);
+      if (fd < 0) {
+        return;
+      }
+
+      struct stat info {};
+      const bool is_stat = ::fstat(fd, &info) == 0;
+      if (is_stat && S_ISREG(info.st_mode) && info.st_size > 0) {
+        const auto size = static_cast<std::size_t>(info.st_size);
+        void *data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+          // the parser reads from the front to the back, once
+          ::posix_madvise(data, size, POSIX_MADV_SEQUENTIAL);
+          m_data = data;
+          m_size = size;
+          m_open = true;
+        }
+      } else if (is_stat && S_ISREG(info.st_mode)) {
+        m_open = true;
+      }
+      ::close(fd);
+
+      if (m_open || (is_stat && S_ISDIR(info.st_mode))) {
+        return;
+      }
+#endif
+      read(t_filename);
+    }
+
+    Mapped_File(Mapped_File &&t_other) noexcept
+        : m_buffer(std::move(t_other.m_buffer))
+        , m_data(std::exchange(t_other.m_data, nullptr))
+        , m_size(std::exchange(t_other.m_size, 0))
+        , m_open(std::exchange(t_other.m_open, false)) {
+    }
+
+    Mapped_File &operator=(Mapped_File &&t_other) noexcept {
+      if (this != &t_other) {
+        unmap();
+        m_buffer = std::move(t_other.m_buffer);
+        m_data = std::exchange(t_other.m_data, nullptr);
+        m_size = std::exchange(t_other.m_size, 0);
+        m_open = std::exchange(t_other.m_open, false);
+      }
+      return *this;
+    }
+
+    Mapped_File(const Mapped_File &) = delete;
+    Mapped_File &operator=(const Mapped_File &) = delete;
+
+    ~Mapped_File() { unmap(); }
+
+    bool is_open() const noexcept { return m_open; }
+
+    /// \returns true if the contents are mapped rather than read into memory
+    bool is_mapped() const noexcept { return m_data != nullptr; }
+
+    /// The contents, valid as long as this is
+    std::string_view text() const noexcept {
+      if (m_data != nullptr) {
+        return std::string_view(static_cast<const char *>(m_data), m_size);
+      } else {
+        return m_buffer;
+      }
+    }
+
+  private:
+    void read(const std::string &t_filename) {
+      std::ifstream infile(t_filename, std::ios::in | std::ios::binary);
+      if (infile.is_open()) {
+        m_buffer.assign(std::istreambuf_iterator<char>(infile), std::istreambuf_iterator<char>());
+        m_open = true;
+      }
+    }
+
+    void unmap() noexcept {
+#ifdef CHAISCRIPT_HAS_MMAP
+      if (m_data != nullptr) {
+        ::munmap(m_data, m_size);
+      }
+#endif
+      m_data = nullptr;
+      m_size = 0;
+    }
+
+    std::string m_buffer;
+    void *m_data = nullptr;
+    std::size_t m_size = 0;
+    bool m_open = false;
+  };
+} // namespace chaiscript::utility
+
+#undef CHAISCRIPT_HAS_MMAP
+
+#endif
@@ -10,40 +10,58 @@
 #ifndef CHAISCRIPT_STACK_VECTOR_HPP_
 #define CHAISCRIPT_STACK_VECTOR_HPP_
 
+#include <cstddef>
 #include <cstdint>
-#include <string>
+#include <new>
 #include <type_traits>
+#include <utility>
 
-template<typename T, std::size_t MaxSize>
-struct Stack_Vector {
-  constexpr static auto aligned_size = sizeof(T) + (sizeof(T) & std::alignment_of_v<T>) > 0 ? std::alignment_of_v<T> : 0;
+namespace chaiscript::utility {
+  /// Fixed capacity vector whose storage lives inside the object itself, so that
+  /// short sequences (function call arguments, for instance) can be built without
+  /// touching the heap. The caller is responsible for never exceeding MaxSize.
+  template<typename T, std::size_t MaxSize>
+  struct Stack_Vector {
+    Stack_Vector() = default;
+    Stack_Vector(const Stack_Vector &) = delete;
+    Stack_Vector(Stack_Vector &&) = delete;
+    Stack_Vector &operator=(const Stack_Vector &) = delete;
+    Stack_Vector &operator=(Stack_Vector &&) = delete;
 
-  alignas(std::alignment_of_v<T>) char data[aligned_size * MaxSize];
+    alignas(T) std::byte data[sizeof(T) * MaxSize];
 
-  [[nodiscard]] T &operator[](const std::size_t idx) noexcept { return *reinterpret_cast<T *>(&data + aligned_size * idx); }
+    [[nodiscard]] T *begin() noexcept { return std::launder(reinterpret_cast<T *>(data)); }
+    [[nodiscard]] const T *begin() const noexcept { return std::launder(reinterpret_cast<const T *>(data)); }
 
-  [[nodiscard]] const T &operator[](const std::size_t idx) const noexcept {
-    return *reinterpret_cast<const T *>(&data + aligned_size * idx);
-  }
+    [[nodiscard]] T *end() noexcept { return begin() + m_size; }
+    [[nodiscard]] const T *end() const noexcept { return begin() + m_size; }
 
-  template<typename... Param>
-  T &emplace_back(Param &&...param) {
-    auto *p = new (&(*this)[m_size++]) T(std::forward<Param>(param)...);
-    return *p;
-  };
+    [[nodiscard]] T &operator[](const std::size_t idx) noexcept { return begin()[idx]; }
+    [[nodiscard]] const T &operator[](const std::size_t idx) const noexcept { return begin()[idx]; }
+
+    template<typename... Param>
+    T &emplace_back(Param &&...param) {
+      auto *p = new (data + sizeof(T) * m_size) T(std::forward<Param>(param)...);
+      ++m_size;
+      return *p;
+    }
 
-  auto size() const noexcept { return m_size; };
+    [[nodiscard]] std::size_t size() const noexcept { return m_size; }
 
-  void pop_back() noexcept(std::is_nothrow_destructible_v<T>) { (*this)[--m_size].~T(); }
+    [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
 
-  ~Stack_Vector() noexcept(std::is_nothrow_destructible_v<T>) {
-    auto loc = m_size - 1;
-    for (std::size_t pos = 0; pos < m_size; ++pos) {
-      (*this)[loc--].~T();
+    static constexpr std::size_t capacity() noexcept { return MaxSize; }
+
+    void pop_back() noexcept(std::is_nothrow_destructible_v<T>) { (*this)[--m_size].~T(); }
+
+    ~Stack_Vector() noexcept(std::is_nothrow_destructible_v<T>) {
+      while (m_size > 0) {
+        pop_back();
+      }
     }
-  }
 
-  std::size_t m_size{0};
-};
+    std::size_t m_size{0};
+  };
+} // namespace chaiscript::utility
 
-#endif CHAISCRIPT_STACK_VECTOR_HPP_
+#endif
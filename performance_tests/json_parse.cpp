@@ -0,0 +1,39 @@
+#include <chaiscript/chaiscript.hpp>
+#include <chaiscript/chaiscript_stdlib.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Parses a few MB of JSON with from_json and reports the throughput, for compact records, the same records
+// indented as to_json writes them, and records made mostly of long strings
+int main() {
+  std::string records;
+  std::string strings;
+  for (int i = 0; i < 20000; ++i) {
+    records += (i == 0 ? "" : ", ");
+    records += "\"key_" + std::to_string(i) + "\": {\"id\": " + std::to_string(i * 7919)
+               + ", \"score\": 3.25e-2, \"name\": \"record \\\"" + std::to_string(i) + "\\\" of many\", \"tags\": [true, false, null]}";
+    strings += (i == 0 ? "" : ", ");
+    strings += "\"" + std::string(200, 'x') + " line " + std::to_string(i) + "\\n" + std::string(100, 'y') + "\"";
+  }
+
+  chaiscript::ChaiScript chai;
+  const auto from_json = chai.eval<std::function<chaiscript::Boxed_Value(const std::string &)>>("from_json");
+  const auto to_json = chai.eval<std::function<std::string(const chaiscript::Boxed_Value &)>>("to_json");
+
+  const std::string compact = "{" + records + "}";
+  const std::string corpus[][2] = {{"compact", compact}, {"indented", to_json(from_json(compact))}, {"strings", "[" + strings + "]"}};
+
+  for (const auto &[name, json] : corpus) {
+    const int runs = 10;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < runs; ++i) {
+      from_json(json);
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+    std::cout << "from_json " << name << ": " << (static_cast<double>(json.size()) * runs / (1024.0 * 1024.0)) / elapsed.count()
+              << " MB/s\n";
+  }
+}
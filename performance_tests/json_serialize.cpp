@@ -0,0 +1,31 @@
+#include <chaiscript/chaiscript.hpp>
+#include <chaiscript/chaiscript_stdlib.hpp>
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+// Writes a few MB of nested JSON with to_json and reports the throughput
+int main() {
+  chaiscript::ChaiScript chai;
+
+  const auto doc = chai.eval(R"(
+    var doc = Map();
+    for (var i = 0; i < 20000; ++i) {
+      doc["key_" + to_string(i)] = ["id": i * 7919, "score": 0.0325, "name": "record \"" + to_string(i) + "\" of many",
+                                    "tags": [true, false, ["depth": [i, i + 1]]]];
+    }
+    doc
+  )");
+  const auto to_json = chai.eval<std::function<std::string(const chaiscript::Boxed_Value &)>>("to_json");
+
+  const int runs = 10;
+  std::size_t bytes = 0;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < runs; ++i) {
+    bytes += to_json(doc).size();
+  }
+  const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+  std::cout << "to_json: " << (static_cast<double>(bytes) / (1024.0 * 1024.0)) / elapsed.count() << " MB/s\n";
+}
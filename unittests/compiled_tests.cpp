@@ -17,6 +17,9 @@
 #include <chaiscript/chaiscript.hpp>
 #include <chaiscript/chaiscript_basic.hpp>
 #include <chaiscript/dispatchkit/bootstrap_stl.hpp>
+#include <chaiscript/utility/interned_string.hpp>
+#include <chaiscript/utility/json_scan.hpp>
+#include <chaiscript/utility/mapped_file.hpp>
 #include <chaiscript/utility/utility.hpp>
 
 #include "../static_libs/chaiscript_parser.hpp"
@@ -25,6 +28,8 @@
 #define CATCH_CONFIG_MAIN
 
 #include <clocale>
+#include <filesystem>
+#include <fstream>
 
 #include "catch.hpp"
 
@@ -89,6 +94,24 @@ TEST_CASE("Dynamic_Object attributes can be shared with C++") {
   CHECK(chaiscript::boxed_cast<int>(chai("x.z")) == 20);
 }
 
+TEST_CASE("Copies of Dynamic_Objects with many attributes keep their own layout") {
+  chaiscript::dispatch::Dynamic_Object obj("copied");
+  for (int i = 0; i < 40; ++i) {
+    obj.get_attr("a" + std::to_string(i)) = chaiscript::Boxed_Value(i);
+  }
+
+  chaiscript::dispatch::Dynamic_Object copy(obj);
+  copy.get_attr("only_in_copy") = chaiscript::Boxed_Value(1);
+  obj.get_attr("only_in_original") = chaiscript::Boxed_Value(2);
+
+  CHECK(copy.get_shape() != obj.get_shape());
+  CHECK(!obj.has_attr("only_in_copy"));
+  CHECK(!copy.has_attr("only_in_original"));
+  CHECK(chaiscript::boxed_cast<int>(copy.get_attr("a39")) == 39);
+  CHECK(chaiscript::boxed_cast<int>(obj.get_attr("only_in_original")) == 2);
+  CHECK(copy.get_attrs().size() == 41);
+}
+
 TEST_CASE("Function objects can be created from chaiscript functions") {
   chaiscript::ChaiScript_Basic chai(create_chaiscript_stdlib(), create_chaiscript_parser());
 
@@ -1283,3 +1306,295 @@ TEST_CASE("Test if non copyable/movable types can be registered") {
   chai.add(chaiscript::user_type<Nothing>(), "Nothing");
   chai.add(chaiscript::constructor<Nothing()>(), "Nothing");
 }
+
+TEST_CASE("Call a script function over a batch of inputs") {
+  chaiscript::ChaiScript_Basic chai(create_chaiscript_stdlib(), create_chaiscript_parser());
+  chai.eval("def score(x) { x * 2.0 + 1 }");
+  chai.eval("def add(x, y) { x + y }");
+
+  const std::vector<double> inputs{1.0, 2.0, 3.5};
+  std::vector<double> outputs(inputs.size());
+  chai.call_batch(chai.eval("score"), std::span<const double>(inputs), std::span<double>(outputs));
+  CHECK(outputs == std::vector<double>{3.0, 5.0, 8.0});
+
+  const std::vector<std::tuple<int, int>> pairs{{1, 2}, {3, 4}};
+  std::vector<int> sums(pairs.size());
+  chai.call_batch(chai.eval("add"), std::span<const std::tuple<int, int>>(pairs), std::span<int>(sums));
+  CHECK(sums == std::vector<int>{3, 7});
+
+  std::vector<double> too_small(1);
+  CHECK_THROWS_AS(chai.call_batch(chai.eval("score"), std::span<const double>(inputs), std::span<double>(too_small)), std::range_error);
+
+  // results are converted as boxed_cast would, never narrowed
+  std::vector<int> truncated(inputs.size());
+  CHECK_THROWS_AS(chai.call_batch(chai.eval("score"), std::span<const double>(inputs), std::span<int>(truncated)), chaiscript::exception::bad_boxed_cast);
+  std::vector<std::string> texts(inputs.size());
+  CHECK_THROWS_AS(chai.call_batch(chai.eval("score"), std::span<const double>(inputs), std::span<std::string>(texts)), chaiscript::exception::bad_boxed_cast);
+}
+
+TEST_CASE("Hoist calls of pure functions out of loops") {
+  chaiscript::ChaiScript_Basic chai(create_chaiscript_stdlib(), create_chaiscript_parser());
+
+  int calls = 0;
+  chai.add(chaiscript::fun([&calls](const int i) { ++calls; return i * 10; }, chaiscript::pure), "scaled");
+  chai.add(chaiscript::fun([&calls](const int i) { ++calls; return i * 10; }), "impure_scaled");
+  chai.add(chaiscript::fun([](std::vector<chaiscript::Boxed_Value> &v) { v.clear(); }), "wipe");
+
+  // invariant, and shared between the two identical expressions
+  CHECK(chai.eval<int>("var n = 3; var sum = 0; for (var i = 0; i < 5; ++i) { sum += scaled(n) + i + scaled(n) } sum") == 310);
+  CHECK(calls == 1);
+
+  // every run of the loop evaluates it again
+  calls = 0;
+  CHECK(chai.eval<int>("var total = 0; for (var j = 0; j < 3; ++j) { var k = 0; while (k < 4) { total += scaled(j); ++k } } total") == 120);
+  CHECK(calls == 3);
+
+  // not pure
+  calls = 0;
+  chai.eval("for (var i = 0; i < 5; ++i) { impure_scaled(n) }");
+  CHECK(calls == 5);
+
+  // reads a variable the loop assigns to
+  calls = 0;
+  chai.eval("var m = 1; for (var i = 0; i < 5; ++i) { scaled(m); m = i }");
+  CHECK(calls == 5);
+
+  // reads an object the loop passes to a function that is not pure
+  CHECK(chai.eval<int>("var v = [1, 2, 3]; var sizes = 0; for (var i = 0; i < 3; ++i) { sizes += v.size(); wipe(v) } sizes") == 3);
+
+  // changing the loop variable of a ranged for changes the container
+  chai.add(chaiscript::fun(
+               [](const std::vector<chaiscript::Boxed_Value> &rows) {
+                 size_t total = 0;
+                 for (const auto &row : rows) {
+                   total += chaiscript::boxed_cast<const std::vector<chaiscript::Boxed_Value> &>(row).size();
+                 }
+                 return total;
+               },
+               chaiscript::pure),
+           "total_size");
+  CHECK(chai.eval<std::string>("var rows = [[1], [2]]; var seen = []; for (row : rows) { seen.push_back(total_size(rows)); row.push_back(0) } to_string(seen)")
+        == "[2, 3]");
+
+  // the loop calls a script function
+  calls = 0;
+  chai.eval("def helper(x) { x } for (var i = 0; i < 5; ++i) { helper(scaled(n)) }");
+  CHECK(calls == 5);
+}
+
+TEST_CASE("Fold calls of pure functions with constant arguments") {
+  chaiscript::ChaiScript_Basic chai(create_chaiscript_stdlib(), create_chaiscript_parser());
+
+  int calls = 0;
+  chai.add(chaiscript::fun([&calls](const std::string &s) { ++calls; return s.size() * 31; }, chaiscript::pure), "hash");
+  chai.add(chaiscript::fun([&calls](const std::string &s) { ++calls; return s.size() * 31; }), "impure_hash");
+  chaiscript::Module m;
+  m.add(chaiscript::fun([&calls](const int i) { ++calls; return i * 10; }), "scaled", chaiscript::pure);
+  chai.add(std::make_shared<chaiscript::Module>(std::move(m)));
+
+  chai.eval("def keyed() { hash(\"key\") } def ten() { scaled(1) }");
+  for (int i = 0; i < 5; ++i) {
+    CHECK(chai.eval<size_t>("keyed()") == 93);
+    CHECK(chai.eval<int>("ten()") == 10);
+  }
+  CHECK(calls == 2);
+
+  // the folded value is a copy, changing it does not change the next result
+  CHECK(chai.eval<size_t>("var h = keyed(); h += 1; keyed()") == 93);
+  CHECK(calls == 2);
+
+  // not pure
+  calls = 0;
+  chai.eval("for (var i = 0; i < 5; ++i) { var h = impure_hash(\"key\") }");
+  CHECK(calls == 5);
+
+  // an overload whose guard rejects the arguments does not matter
+  calls = 0;
+  chai.eval("def hash(string s) : s == \"\" { 7 }");
+  CHECK(chai.eval<size_t>("keyed()") == 93);
+  CHECK(chai.eval<size_t>("keyed()") == 93);
+  CHECK(calls == 1);
+
+  // one that is not pure, and that the arguments also match, stops the folding
+  calls = 0;
+  chai.eval("def hash(string s) : s == \"key\" { 7 }");
+  CHECK(chai.eval<size_t>("keyed()") == 93);
+  CHECK(chai.eval<size_t>("keyed()") == 93);
+  CHECK(calls == 2);
+
+  // a name that now refers to something else is called from then on
+  calls = 0;
+  chai.eval("global hash = fun(s) { 7 }");
+  CHECK(chai.eval<int>("keyed()") == 7);
+  CHECK(calls == 0);
+
+  // overloads the arguments do not match do not matter
+  chai.add(chaiscript::fun([&calls](const std::string &s) { ++calls; return static_cast<int>(s.size()); }), "scaled");
+  CHECK(chai.eval<int>("ten()") == 10);
+  CHECK(chai.eval<int>("ten()") == 10);
+  CHECK(calls == 1);
+}
+
+TEST_CASE("Ranged for walks registered C++ containers natively") {
+  chaiscript::ChaiScript_Basic chai(create_chaiscript_stdlib(), create_chaiscript_parser());
+
+  chaiscript::Module m;
+  chaiscript::bootstrap::standard_library::vector_type<std::vector<double>>("DoubleVector", m);
+  chai.add(std::make_shared<chaiscript::Module>(std::move(m)));
+  std::vector<double> values{1.5, 2.5, 3.0};
+  chai.add(chaiscript::var(&values), "values");
+
+  CHECK(chai.eval<double>("var sum = 0.0; for (v : values) { sum += v; } sum") == Approx(7.0));
+
+  // elements are bound by reference
+  chai.eval("for (v : values) { v *= 2.0; }");
+  CHECK(values == std::vector<double>{3.0, 5.0, 6.0});
+
+  // a type with only begin() and end(), registered by hand
+  struct Bag {
+    std::vector<int> items;
+    auto begin() const { return items.begin(); }
+    auto end() const { return items.end(); }
+  };
+  chai.add(chaiscript::user_type<Bag>(), "Bag");
+  chai.add(chaiscript::native_iteration<Bag>());
+  chai.add(chaiscript::const_var(Bag{{1, 2, 3, 4}}), "bag");
+
+  CHECK(chai.eval<int>("var total = 0; for (i : bag) { if (i == 3) { break; } total += i; } total") == 3);
+}
+
+TEST_CASE("Read newline delimited JSON from a file a line at a time") {
+  chaiscript::ChaiScript_Basic chai(create_chaiscript_stdlib(), create_chaiscript_parser());
+
+  const auto filename = (std::filesystem::temp_directory_path() / "chaiscript_ndjson_test.ndjson").string();
+  {
+    std::ofstream out(filename);
+    for (int i = 0; i < 10000; ++i) {
+      out << "{\"id\": " << i << ", \"name\": \"record " << i << "\"}\n";
+    }
+  }
+
+  chai.add(chaiscript::var(filename), "filename");
+  CHECK(chai.eval<int>("var total = 0; for (r : ndjson_file(filename)) { total += r[\"id\"]; } total") == 49995000);
+  CHECK(chai.eval<std::string>("var reader = ndjson_file(filename); reader.pop_front(); reader.front()[\"name\"]") == "record 1");
+
+  std::filesystem::remove(filename);
+  CHECK_THROWS(chai.eval("ndjson_file(filename)"));
+}
+
+TEST_CASE("JSON scanning finds the same characters a block at a time as one at a time") {
+  using chaiscript::json::detail::Scalar_Scanner;
+  using chaiscript::json::detail::Scanner;
+
+  const std::string specials{' ', '\t', '\n', '\v', '\f', '\r', '\"', '\\', '\x01', '\x1f', 'a', '\x7f', '\x80', '\xe9', '\xff'};
+  for (const char filler : {'a', ' ', '\n', '\xe9'}) {
+    for (const char special : specials) {
+      for (std::size_t length = 0; length < 80; ++length) {
+        for (std::size_t at = 0; at <= length; ++at) {
+          std::string text(length, filler);
+          if (at < length) {
+            text[at] = special;
+          }
+          const char *begin = text.data();
+          const char *end = text.data() + text.size();
+          REQUIRE(Scanner::skip_space(begin, end) == Scalar_Scanner::skip_space(begin, end));
+          REQUIRE(Scanner::find_string_run_end(begin, end) == Scalar_Scanner::find_string_run_end(begin, end));
+          REQUIRE(Scanner::find_escape(begin, end) == Scalar_Scanner::find_escape(begin, end));
+        }
+      }
+    }
+  }
+}
+
+TEST_CASE("Interned strings share one entry per name") {
+  using chaiscript::utility::Interned_String;
+
+  const Interned_String name("interned_test_name");
+  const Interned_String same(std::string("interned_test_") + "name");
+  const Interned_String other("interned_test_other");
+
+  CHECK(name == same);
+  CHECK(&name.str() == &same.str());
+  CHECK(!(name == other));
+  CHECK(name == std::string_view("interned_test_name"));
+  CHECK(name.hash() == chaiscript::utility::hash(std::string_view("interned_test_name")));
+  CHECK(Interned_String::Hash()(name) == Interned_String::Hash()(std::string_view("interned_test_name")));
+
+  CHECK(Interned_String().empty());
+  CHECK(Interned_String("") == Interned_String());
+  CHECK(Interned_String().str().empty());
+
+  const chaiscript::utility::Lazy_Interned_String lazy;
+  CHECK(lazy.get("interned_test_name") == name);
+  CHECK(lazy.get("interned_test_name") == name);
+  CHECK(chaiscript::utility::Lazy_Interned_String().get("").empty());
+}
+
+TEST_CASE("Globals and functions are found by name however it is given") {
+  chaiscript::ChaiScript_Basic chai(create_chaiscript_stdlib(), create_chaiscript_parser());
+  chai.add_global(chaiscript::var(41), "interned_global");
+  chai.add(chaiscript::fun([](int i) { return i + 1; }), "interned_function");
+
+  CHECK(chai.eval<int>("interned_function(interned_global)") == 42);
+  CHECK(chai.eval<int>("var f = interned_function; f(1)") == 2);
+
+  chai.set_global(chaiscript::var(1), "interned_global");
+  CHECK(chai.eval<int>("interned_global") == 1);
+  CHECK_THROWS_AS(chai.add_global(chaiscript::var(2), "interned_global"), chaiscript::exception::name_conflict_error);
+}
+
+TEST_CASE("Script files are parsed straight from the mapped file") {
+  chaiscript::ChaiScript_Basic chai(create_chaiscript_stdlib(), create_chaiscript_parser());
+  const auto directory = std::filesystem::temp_directory_path();
+
+  const auto write = [](const std::filesystem::path &t_path, const std::string &t_text) {
+    std::ofstream out(t_path, std::ios::binary);
+    out << t_text;
+  };
+
+  const auto with_bom = directory / "chaiscript_mapped_bom.chai";
+  write(with_bom, "\xef\xbb\xbf" "1 + 2");
+  CHECK(chai.eval_file<int>(with_bom.string()) == 3);
+
+  const auto empty = directory / "chaiscript_mapped_empty.chai";
+  write(empty, "");
+  CHECK_NOTHROW(chai.eval_file(empty.string()));
+
+  // a script that ends right at a page boundary, with nothing mapped after its last character
+  const auto page = directory / "chaiscript_mapped_page.chai";
+  std::string script = "var mapped_total = 40 + 2 ";
+  script.append(4096 - script.size() - 1, ' ');
+  script += ';';
+  write(page, script);
+  chai.eval_file(page.string());
+  CHECK(chai.eval<int>("mapped_total") == 42);
+
+  const chaiscript::utility::Mapped_File mapped(page.string());
+  CHECK(mapped.is_open());
+  CHECK(mapped.text() == script);
+  CHECK(!chaiscript::utility::Mapped_File((directory / "chaiscript_mapped_missing.chai").string()).is_open());
+  CHECK_THROWS_AS(chai.eval_file((directory / "chaiscript_mapped_missing.chai").string()), chaiscript::exception::file_not_found_error);
+
+  std::filesystem::remove(with_bom);
+  std::filesystem::remove(empty);
+  std::filesystem::remove(page);
+}
+
+TEST_CASE("Native algorithms come with the standard library") {
+  chaiscript::ChaiScript_Basic bare(std::make_shared<chaiscript::Module>(), create_chaiscript_parser());
+  CHECK(!bare.eval<bool>("function_exists(\"map\")"));
+  CHECK(!bare.eval<bool>("function_exists(\"format\")"));
+
+  chaiscript::ChaiScript_Basic chai(create_chaiscript_stdlib(), create_chaiscript_parser());
+  CHECK(chai.eval<double>("sum([1, 2, 3])") == 6.0);
+  CHECK(chai.eval<std::string>("format(\"{}-{}\", 1, \"a\")") == "1-a");
+}
+
+TEST_CASE("Only the prelude's own functions are given lazy ranges") {
+  chaiscript::ChaiScript_Basic chai(create_chaiscript_stdlib(), create_chaiscript_parser());
+
+  // named like the prelude's file, but not evaluated as a library script
+  chai.eval("def sum(v, k) { var c = v; c.push_back(k); c.size() }", chaiscript::Exception_Handler(), "standard prelude");
+  CHECK(chai.eval<std::size_t>("sum([1..5], 10)") == 6u);
+  CHECK(chai.eval<double>("sum([1..4])") == 10.0);
+}